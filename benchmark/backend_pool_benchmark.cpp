@@ -0,0 +1,107 @@
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/backend_pool.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Many loggers with skewed activity: one backend thread each vs a shared BackendPool
+// Logger i receives a share of the records proportional to 1 / (i + 1), so a handful of
+// loggers carry most of the volume while the rest are nearly idle. Time is measured until
+// every record reached its sink.
+// Args: {loggers, pool workers (0 = thread per logger)}
+
+namespace
+{
+constexpr std::size_t POOL_BENCH_RECORDS = 200000;
+constexpr int POOL_BENCH_PRODUCERS = 4;
+using PoolBenchLogger = zerg::Logger<(1ULL << 50), 16 * 1024>;
+
+class CountingBackend : public zerg::ILogBackend
+{
+  public:
+    explicit CountingBackend(std::atomic<std::size_t> &written) : _written(written) {}
+    void write(const char *, std::streamsize) override
+    {
+        _written.fetch_add(1, std::memory_order_relaxed);
+    }
+    void writeNewline() override {}
+    void flush() override {}
+
+  private:
+    std::atomic<std::size_t> &_written;
+};
+
+void manyLoggers(benchmark::State &state)
+{
+    const auto count = static_cast<std::size_t>(state.range(0));
+    const auto workers = static_cast<std::size_t>(state.range(1));
+
+    // zipf-like assignment of records to loggers
+    std::vector<std::size_t> targets;
+    targets.reserve(POOL_BENCH_RECORDS);
+    double harmonic = 0.0;
+    for (std::size_t i = 0; i < count; ++i)
+        harmonic += 1.0 / static_cast<double>(i + 1);
+    for (std::size_t i = 0; i < count; ++i)
+    {
+        const auto share = static_cast<std::size_t>(static_cast<double>(POOL_BENCH_RECORDS) /
+                                                    (static_cast<double>(i + 1) * harmonic));
+        targets.insert(targets.end(), std::max<std::size_t>(share, 1), i);
+    }
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        std::atomic<std::size_t> written{0};
+        auto pool = workers == 0 ? nullptr : std::make_unique<zerg::BackendPool>(workers);
+        std::vector<std::unique_ptr<PoolBenchLogger>> loggers;
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            loggers.push_back(std::make_unique<PoolBenchLogger>(
+                "unused", zerg::Verbosity::DEBUG_LVL, std::make_unique<CountingBackend>(written),
+                pool.get()));
+        }
+        state.ResumeTiming();
+
+        std::vector<std::thread> producers;
+        for (int p = 0; p < POOL_BENCH_PRODUCERS; ++p)
+        {
+            producers.emplace_back([&, p] {
+                for (std::size_t r = static_cast<std::size_t>(p); r < targets.size();
+                     r += POOL_BENCH_PRODUCERS)
+                {
+                    loggers[targets[r]]->log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__,
+                                             "request {} done", r);
+                }
+            });
+        }
+        for (auto &producer : producers)
+            producer.join();
+
+        std::size_t dropped = 0;
+        for (const auto &logger : loggers)
+            dropped += logger->droppedCount();
+        while (written.load(std::memory_order_relaxed) < targets.size() - dropped)
+        {
+        }
+
+        state.PauseTiming();
+        state.counters["dropped"] = static_cast<double>(dropped);
+        state.counters["steals"] = pool ? static_cast<double>(pool->steals()) : 0.0;
+        loggers.clear();
+        pool.reset();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * targets.size()));
+}
+} // namespace
+
+BENCHMARK(manyLoggers)
+    ->ArgNames({"loggers", "workers"})
+    ->ArgsProduct({{16, 256}, {0, 2, 4}})
+    ->Iterations(5)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
@@ -0,0 +1,87 @@
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/tsc_clock.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <atomic>
+#include <cstdlib>
+#include <memory>
+#include <thread>
+#include <vector>
+
+// Producer side latency, default backend (condition variable) vs Logger::enableBusyPoll
+// A paced producer logs one record every PACE_NS so the queue never fills and each call
+// sees the steady state path: in the default mode that includes _cv.notify_one (a futex
+// wake whenever the backend went to sleep), in busy poll mode only the enqueue.
+//   ZERG_BUSY_POLL_CPU=n      pin the spinning backend to cpu n (default: unpinned)
+// Counters: p50/p99/p999/max_ns per call, measured with TscClock.
+
+namespace
+{
+constexpr std::size_t BUSY_POLL_RECORDS = 200000;
+constexpr std::uint64_t PACE_NS = 2000;
+using BusyPollLogger = zerg::Logger<(1ULL << 50), 64 * 1024>;
+
+class NullBackend : public zerg::ILogBackend
+{
+  public:
+    void write(const char *, std::streamsize) override {}
+    void writeNewline() override {}
+    void flush() override {}
+};
+
+double percentile(const std::vector<double> &sorted, const double p)
+{
+    return sorted[static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1))];
+}
+
+template <bool BusyPoll> void producerLatency(benchmark::State &state)
+{
+    const zerg::TscClock &clock = zerg::TscClock::instance();
+    const auto pace_ticks = static_cast<std::uint64_t>(static_cast<double>(PACE_NS) /
+                                                       clock.nsPerTick());
+    const char *cpu_env = ::getenv("ZERG_BUSY_POLL_CPU");
+    const int cpu = cpu_env != nullptr ? std::atoi(cpu_env) : -1;
+
+    for (auto _ : state)
+    {
+        BusyPollLogger logger("unused", zerg::Verbosity::DEBUG_LVL,
+                              std::make_unique<NullBackend>());
+        if (BusyPoll)
+            logger.enableBusyPoll(cpu);
+
+        std::vector<double> latencies;
+        latencies.reserve(BUSY_POLL_RECORDS);
+        std::uint64_t due = zerg::TscClock::now();
+        for (std::size_t i = 0; i < BUSY_POLL_RECORDS; ++i)
+        {
+            due += pace_ticks;
+            while (zerg::TscClock::now() < due)
+            {
+            }
+            const std::uint64_t t0 = zerg::TscClock::now();
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "order {} px {}", i, 101.25);
+            latencies.push_back(static_cast<double>(zerg::TscClock::now() - t0) *
+                                clock.nsPerTick());
+        }
+
+        state.PauseTiming();
+        logger.sync();
+        std::sort(latencies.begin(), latencies.end());
+        state.counters["p50_ns"] = percentile(latencies, 0.50);
+        state.counters["p99_ns"] = percentile(latencies, 0.99);
+        state.counters["p999_ns"] = percentile(latencies, 0.999);
+        state.counters["max_ns"] = latencies.back();
+        state.counters["dropped"] = static_cast<double>(logger.droppedCount());
+        state.ResumeTiming();
+    }
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(producerLatency, false)
+    ->Name("producerLatency/default")
+    ->Iterations(1)
+    ->UseRealTime();
+BENCHMARK_TEMPLATE(producerLatency, true)
+    ->Name("producerLatency/busy_poll")
+    ->Iterations(1)
+    ->UseRealTime();
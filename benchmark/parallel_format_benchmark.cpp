@@ -0,0 +1,72 @@
+#include "../include/zerg/logger.hpp"
+#include <benchmark/benchmark.h>
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <string>
+
+// Backend throughput with formatter threads (Logger::setFormatterThreads)
+// The queue is filled while the sink is gated, then the time to drain it through
+// format + write is measured, so producers are out of the picture entirely.
+// Args: {formatter threads, argument length in bytes}
+
+namespace
+{
+constexpr std::size_t PARALLEL_RECORDS = 200000;
+using ParallelLogger = zerg::Logger<(1ULL << 50), 256 * 1024>;
+
+class GatedCountingBackend : public zerg::ILogBackend
+{
+  public:
+    void write(const char *, std::streamsize) override
+    {
+        while (!open.load(std::memory_order_acquire))
+        {
+        }
+        written.fetch_add(1, std::memory_order_release);
+    }
+    void writeNewline() override {}
+    void flush() override {}
+
+    std::atomic<bool> open{false};
+    std::atomic<std::size_t> written{0};
+};
+
+void parallelFormat(benchmark::State &state)
+{
+    const auto formatters = static_cast<std::size_t>(state.range(0));
+    const std::string payload(static_cast<std::size_t>(state.range(1)), 'p');
+
+    for (auto _ : state)
+    {
+        state.PauseTiming();
+        auto backend = std::make_unique<GatedCountingBackend>();
+        auto *sink = backend.get();
+        ParallelLogger logger("unused", zerg::Verbosity::DEBUG_LVL, std::move(backend));
+        logger.setFormatterThreads(formatters);
+        for (std::size_t i = 0; i < PARALLEL_RECORDS; ++i)
+        {
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "request {} payload {}", i,
+                       payload);
+        }
+        state.ResumeTiming();
+
+        sink->open.store(true, std::memory_order_release);
+        const std::size_t expected = PARALLEL_RECORDS - logger.droppedCount();
+        while (sink->written.load(std::memory_order_acquire) < expected)
+        {
+        }
+
+        state.PauseTiming();
+        logger.sync();
+        state.ResumeTiming();
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations() * PARALLEL_RECORDS));
+}
+} // namespace
+
+BENCHMARK(parallelFormat)
+    ->ArgNames({"formatters", "arg_bytes"})
+    ->ArgsProduct({{0, 1, 2, 4}, {64, 512}})
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
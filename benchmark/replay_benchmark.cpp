@@ -0,0 +1,228 @@
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/trace_capture.hpp"
+#include <benchmark/benchmark.h>
+#include <fmt/args.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+// Workload replay
+// Reproduces a trace recorded with zerg::enableTraceCapture / Logger::setTraceRecorder
+// against several logger configurations. Arguments are synthesised with the recorded
+// types and sizes, each recorded thread gets its own replay thread.
+//
+//   ZERG_TRACE=app.ztrc          trace to replay (benchmarks are skipped without it)
+//   ZERG_REPLAY_SPEED=1          1 = original pacing, 10 = 10x faster, 0 = back to back
+//
+// Counters: p50/p99/p999/max_ns per call, records, dropped, skipped (callsites whose
+// format could not be applied to synthesised arguments) and achieved records/s.
+
+namespace
+{
+using Clock = std::chrono::steady_clock;
+using ArgStore = fmt::dynamic_format_arg_store<fmt::format_context>;
+
+struct ReplayCall
+{
+    const zerg::TraceCallsite *site;
+    zerg::Verbosity level;
+    std::int64_t time_ns;
+    std::shared_ptr<ArgStore> args;
+};
+
+std::shared_ptr<ArgStore> synthesise(const std::vector<zerg::TraceArg> &args)
+{
+    auto store = std::make_shared<ArgStore>();
+    for (const auto &arg : args)
+    {
+        switch (arg.type)
+        {
+        case zerg::TraceArgType::BOOL:
+            store->push_back(true);
+            break;
+        case zerg::TraceArgType::CHAR:
+            store->push_back('x');
+            break;
+        case zerg::TraceArgType::INT:
+            if (arg.size > sizeof(int))
+                store->push_back(static_cast<long long>(1234567890123));
+            else
+                store->push_back(12345);
+            break;
+        case zerg::TraceArgType::UINT:
+            if (arg.size > sizeof(unsigned))
+                store->push_back(static_cast<unsigned long long>(1234567890123));
+            else
+                store->push_back(12345U);
+            break;
+        case zerg::TraceArgType::FLOAT:
+            if (arg.size > sizeof(float))
+                store->push_back(3.14159265358979);
+            else
+                store->push_back(3.14159F);
+            break;
+        case zerg::TraceArgType::POINTER:
+            store->push_back(static_cast<const void *>(store.get()));
+            break;
+        case zerg::TraceArgType::C_STR:
+        case zerg::TraceArgType::STRING:
+        case zerg::TraceArgType::OTHER:
+            store->push_back(std::string(arg.size, 'x'));
+            break;
+        }
+    }
+    return store;
+}
+
+struct ReplayPlan
+{
+    std::vector<std::vector<ReplayCall>> threads;
+    std::size_t skipped{};
+};
+
+const zerg::Trace *loadTrace()
+{
+    static const std::unique_ptr<zerg::Trace> trace = []() -> std::unique_ptr<zerg::Trace> {
+        const char *path = ::getenv("ZERG_TRACE");
+        if (path == nullptr)
+            return nullptr;
+        return std::make_unique<zerg::Trace>(zerg::readTrace(path));
+    }();
+    return trace.get();
+}
+
+ReplayPlan buildPlan(const zerg::Trace &trace)
+{
+    ReplayPlan plan;
+    plan.threads.resize(trace.threads);
+    std::vector<int> usable(trace.callsites.size(), -1);
+    for (const auto &event : trace.events)
+    {
+        auto args = synthesise(event.args);
+        auto &ok = usable[event.callsite];
+        if (ok == -1)
+        {
+            try
+            {
+                (void)fmt::vformat(trace.callsites[event.callsite].format, *args);
+                ok = 1;
+            }
+            catch (const fmt::format_error &)
+            {
+                ok = 0;
+            }
+        }
+        if (ok == 0)
+        {
+            ++plan.skipped;
+            continue;
+        }
+        plan.threads[event.thread].push_back(
+            {&trace.callsites[event.callsite], event.level, event.time_ns, std::move(args)});
+    }
+    return plan;
+}
+
+double replaySpeed()
+{
+    const char *env = ::getenv("ZERG_REPLAY_SPEED");
+    return env != nullptr ? std::strtod(env, nullptr) : 1.0;
+}
+
+double percentile(const std::vector<std::int64_t> &sorted, const double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    return static_cast<double>(
+        sorted[static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1))]);
+}
+
+template <typename LoggerT> void replayInto(benchmark::State &state, const char *sink)
+{
+    const zerg::Trace *trace = loadTrace();
+    if (trace == nullptr)
+    {
+        state.SkipWithError("set ZERG_TRACE to a captured trace");
+        return;
+    }
+    const ReplayPlan plan = buildPlan(*trace);
+    const double speed = replaySpeed();
+
+    for (auto _ : state)
+    {
+        auto logger = std::make_unique<LoggerT>(sink);
+        std::vector<std::vector<std::int64_t>> latencies(plan.threads.size());
+        std::vector<std::thread> threads;
+
+        const auto start = Clock::now() + std::chrono::milliseconds(10);
+        for (std::size_t t = 0; t < plan.threads.size(); ++t)
+        {
+            threads.emplace_back([&, t] {
+                auto &lat = latencies[t];
+                lat.reserve(plan.threads[t].size());
+                for (const auto &call : plan.threads[t])
+                {
+                    if (speed > 0.0)
+                    {
+                        const auto due =
+                            start + std::chrono::nanoseconds(static_cast<std::int64_t>(
+                                        static_cast<double>(call.time_ns) / speed));
+                        while (Clock::now() < due)
+                        {
+                        }
+                    }
+                    const auto t0 = Clock::now();
+                    logger->vlog(call.level, call.site->file.c_str(), call.site->line,
+                                 call.site->format.c_str(), *call.args);
+                    lat.push_back(
+                        std::chrono::duration_cast<std::chrono::nanoseconds>(Clock::now() - t0)
+                            .count());
+                }
+            });
+        }
+        for (auto &thread : threads)
+            thread.join();
+        const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+
+        state.PauseTiming();
+        logger->sync();
+        std::vector<std::int64_t> all;
+        for (const auto &lat : latencies)
+            all.insert(all.end(), lat.begin(), lat.end());
+        std::sort(all.begin(), all.end());
+
+        state.counters["records"] = static_cast<double>(all.size());
+        state.counters["records_per_s"] = static_cast<double>(all.size()) / elapsed;
+        state.counters["p50_ns"] = percentile(all, 0.50);
+        state.counters["p99_ns"] = percentile(all, 0.99);
+        state.counters["p999_ns"] = percentile(all, 0.999);
+        state.counters["max_ns"] = all.empty() ? 0.0 : static_cast<double>(all.back());
+        state.counters["dropped"] = static_cast<double>(logger->droppedCount());
+        state.counters["skipped"] = static_cast<double>(plan.skipped);
+        logger.reset();
+        state.ResumeTiming();
+    }
+}
+
+constexpr std::size_t REPLAY_MAX_FILE_SIZE = std::numeric_limits<std::size_t>::max();
+
+template <std::size_t BufferSize> void replayDevNull(benchmark::State &state)
+{
+    replayInto<zerg::Logger<REPLAY_MAX_FILE_SIZE, BufferSize>>(state, "/dev/null");
+}
+
+template <std::size_t BufferSize> void replayFile(benchmark::State &state)
+{
+    replayInto<zerg::Logger<REPLAY_MAX_FILE_SIZE, BufferSize>>(state, "zerg_replay.log");
+}
+} // namespace
+
+BENCHMARK_TEMPLATE(replayDevNull, 4 * 1024)->Iterations(1)->UseRealTime();
+BENCHMARK_TEMPLATE(replayDevNull, 64 * 1024)->Iterations(1)->UseRealTime();
+BENCHMARK_TEMPLATE(replayDevNull, 1024 * 1024)->Iterations(1)->UseRealTime();
+BENCHMARK_TEMPLATE(replayFile, 64 * 1024)->Iterations(1)->UseRealTime();
@@ -0,0 +1,56 @@
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/sharded_logger.hpp"
+#include <benchmark/benchmark.h>
+
+// All cores logging into one Logger vs a ShardedLogger with one shard per NUMA node
+// On a single node host both are the same logger plus the sched_getcpu routing cost; the
+// difference shows up on multi-socket machines where the single queue is remote for half
+// the producers.
+
+namespace
+{
+constexpr std::size_t SHARD_MAX_FILE_SIZE = (1ULL << 50) + 3;
+using SingleLogger = zerg::Logger<SHARD_MAX_FILE_SIZE, 256 * 1024>;
+using NodeShardedLogger = zerg::ShardedLogger<SHARD_MAX_FILE_SIZE, 256 * 1024>;
+
+template <typename LoggerT> void logAllCores(benchmark::State &state, LoggerT &logger)
+{
+    for (auto _ : state)
+    {
+        logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "request {} done", 42);
+    }
+    state.SetItemsProcessed(static_cast<std::int64_t>(state.iterations()));
+    if (state.thread_index() == 0)
+        state.counters["dropped"] = static_cast<double>(logger.droppedCount());
+}
+
+// built once and shared by every run, so no thread ever sees it null or being replaced;
+// dropped counts are cumulative across runs
+SingleLogger &singleLogger()
+{
+    static SingleLogger logger("zerg_single.log");
+    return logger;
+}
+
+NodeShardedLogger &shardedLogger()
+{
+    static NodeShardedLogger logger("zerg_sharded.log");
+    return logger;
+}
+
+void singleQueue(benchmark::State &state)
+{
+    logAllCores(state, singleLogger());
+}
+
+void nodeSharded(benchmark::State &state)
+{
+    NodeShardedLogger &sharded = shardedLogger();
+    if (state.thread_index() == 0)
+        state.counters["shards"] = static_cast<double>(sharded.shardCount());
+    logAllCores(state, sharded);
+}
+} // namespace
+
+BENCHMARK(singleQueue)->ThreadPerCpu()->UseRealTime();
+BENCHMARK(nodeSharded)->ThreadPerCpu()->UseRealTime();
@@ -0,0 +1,128 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SLOW_SINK_BACKEND_HPP
+#define SLOW_SINK_BACKEND_HPP
+
+#include "../include/zerg/backend/ilog_backend.hpp"
+#include <atomic>  // std::atomic
+#include <chrono>  // std::chrono::*
+#include <cstdint> // std::int64_t
+#include <mutex>   // std::mutex, std::lock_guard
+#include <thread>  // std::this_thread::sleep_for
+#include <vector>  // std::vector
+
+namespace zerg
+{
+
+struct SlowSinkConfig
+{
+    std::chrono::nanoseconds write_latency{0};    // added to every write()
+    std::chrono::milliseconds stall_period{0};    // time between stalls, 0 disables stalls
+    std::chrono::milliseconds stall_duration{0};  // simulated fsync / NFS hiccup
+    std::int64_t bytes_per_second{0};             // throughput cap, 0 = uncapped
+};
+
+// Fault injecting sink for benchmarks: discards data but behaves like a slow disk.
+// Runs on the logger backend thread, so every delay here backs up the queue.
+class SlowSinkBackend : public ILogBackend
+{
+  public:
+    using Clock = std::chrono::steady_clock;
+
+    explicit SlowSinkBackend(const SlowSinkConfig &config)
+        : _config(config), _start(Clock::now()), _next_stall(_start + config.stall_period)
+    {
+    }
+
+    void write(const char *, std::streamsize size) override
+    {
+        maybeStall();
+        if (_config.write_latency.count() > 0)
+            delay(_config.write_latency);
+        account(size);
+    }
+
+    void writeNewline() override { account(1); }
+
+    void flush() override {}
+
+    // steady clock time points at which each stall ended
+    [[nodiscard]] std::vector<Clock::time_point> stallEnds() const
+    {
+        std::lock_guard<std::mutex> lock(_stall_mutex);
+        return _stall_ends;
+    }
+
+    [[nodiscard]] std::int64_t bytesWritten() const
+    {
+        return _bytes_written.load(std::memory_order_relaxed);
+    }
+
+  private:
+    void maybeStall()
+    {
+        if (_config.stall_period.count() == 0 || Clock::now() < _next_stall)
+            return;
+        std::this_thread::sleep_for(_config.stall_duration);
+        const auto end = Clock::now();
+        _next_stall = end + _config.stall_period;
+        std::lock_guard<std::mutex> lock(_stall_mutex);
+        _stall_ends.push_back(end);
+    }
+
+    void account(const std::streamsize size)
+    {
+        const auto total = _bytes_written.fetch_add(size, std::memory_order_relaxed) + size;
+        if (_config.bytes_per_second <= 0)
+            return;
+        // sleep until the cap allows everything written so far
+        const auto allowed_at =
+            _start + std::chrono::nanoseconds(total * 1000000000 / _config.bytes_per_second);
+        const auto now = Clock::now();
+        if (allowed_at > now)
+            delay(allowed_at - now);
+    }
+
+    static void delay(const Clock::duration duration)
+    {
+        // sleeping has ~50us of slack, spin for anything shorter
+        if (duration > std::chrono::microseconds(100))
+        {
+            std::this_thread::sleep_for(duration);
+            return;
+        }
+        const auto until = Clock::now() + duration;
+        while (Clock::now() < until)
+        {
+        }
+    }
+
+    const SlowSinkConfig _config;
+    const Clock::time_point _start;
+    Clock::time_point _next_stall;
+    std::atomic<std::int64_t> _bytes_written{0};
+    mutable std::mutex _stall_mutex;
+    std::vector<Clock::time_point> _stall_ends;
+};
+
+} // namespace zerg
+
+#endif // SLOW_SINK_BACKEND_HPP
@@ -0,0 +1,139 @@
+#include "../include/zerg/logger.hpp"
+#include "slow_sink_backend.hpp"
+#include <benchmark/benchmark.h>
+#include <algorithm>
+#include <chrono>
+#include <cstdlib>
+#include <limits>
+#include <memory>
+#include <vector>
+
+// Tail latency under backpressure
+// A paced producer logs into a Logger whose sink injects latency, periodic stalls and
+// throughput caps (see SlowSinkBackend). Reported counters:
+//   p50/p99/p999/max_ns  producer side latency of Logger::log
+//   dropped              records rejected because the queue was full
+//   stalls               stalls injected during the run
+//   recovery_avg/max_ms  time from the end of a stall until the producer stopped seeing drops
+//
+// ZERG_SLOW_SINK_SECONDS overrides the run length (default 2 s).
+//
+// Args: {records per second, write latency ns, stall ms, stall period ms, cap bytes/s}
+
+namespace
+{
+using Clock = zerg::SlowSinkBackend::Clock;
+
+constexpr std::size_t SLOW_SINK_QUEUE_SIZE = 4 * 1024;
+using SlowSinkLogger =
+    zerg::Logger<std::numeric_limits<std::size_t>::max(), SLOW_SINK_QUEUE_SIZE>;
+
+double runSeconds()
+{
+    const char *env = ::getenv("ZERG_SLOW_SINK_SECONDS");
+    return env != nullptr ? std::strtod(env, nullptr) : 2.0;
+}
+
+double percentile(std::vector<std::int64_t> &sorted, const double p)
+{
+    if (sorted.empty())
+        return 0.0;
+    const auto idx = static_cast<std::size_t>(p * static_cast<double>(sorted.size() - 1));
+    return static_cast<double>(sorted[idx]);
+}
+
+void slowSinkBenchmark(benchmark::State &state)
+{
+    const auto rate = state.range(0);
+    zerg::SlowSinkConfig config;
+    config.write_latency = std::chrono::nanoseconds(state.range(1));
+    config.stall_duration = std::chrono::milliseconds(state.range(2));
+    config.stall_period = std::chrono::milliseconds(state.range(3));
+    config.bytes_per_second = state.range(4);
+
+    const auto interval = std::chrono::nanoseconds(1000000000 / rate);
+    const auto duration = std::chrono::duration_cast<Clock::duration>(
+        std::chrono::duration<double>(runSeconds()));
+
+    for (auto _ : state)
+    {
+        auto backend = std::make_unique<zerg::SlowSinkBackend>(config);
+        auto *sink = backend.get();
+        SlowSinkLogger logger("slow_sink", zerg::Verbosity::DEBUG_LVL, std::move(backend));
+
+        std::vector<std::int64_t> latencies;
+        latencies.reserve(static_cast<std::size_t>(rate * runSeconds() * 1.1));
+        std::vector<Clock::time_point> drops;
+
+        const auto start = Clock::now();
+        auto next = start;
+        int i = 0;
+        while (next - start < duration)
+        {
+            while (Clock::now() < next)
+            {
+            }
+            const auto before_drops = logger.droppedCount();
+            const auto t0 = Clock::now();
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__,
+                       "request {} served in {} us by worker {}", i, 42 + (i & 127), i & 7);
+            const auto t1 = Clock::now();
+            latencies.push_back(std::chrono::duration_cast<std::chrono::nanoseconds>(t1 - t0)
+                                    .count());
+            if (logger.droppedCount() != before_drops)
+                drops.push_back(t1);
+            ++i;
+            next += interval;
+        }
+
+        state.PauseTiming();
+        logger.sync();
+        state.ResumeTiming();
+
+        // recovery: last drop after each stall end, before the following stall end
+        const auto stall_ends = sink->stallEnds();
+        double recovery_sum = 0.0;
+        double recovery_max = 0.0;
+        for (std::size_t s = 0; s < stall_ends.size(); ++s)
+        {
+            const auto from = stall_ends[s];
+            const auto to =
+                s + 1 < stall_ends.size() ? stall_ends[s + 1] : Clock::time_point::max();
+            auto last = from;
+            for (const auto &drop : drops)
+            {
+                if (drop >= from && drop < to)
+                    last = drop;
+            }
+            const double ms = std::chrono::duration<double, std::milli>(last - from).count();
+            recovery_sum += ms;
+            recovery_max = std::max(recovery_max, ms);
+        }
+
+        std::sort(latencies.begin(), latencies.end());
+        state.counters["records"] = static_cast<double>(latencies.size());
+        state.counters["p50_ns"] = percentile(latencies, 0.50);
+        state.counters["p99_ns"] = percentile(latencies, 0.99);
+        state.counters["p999_ns"] = percentile(latencies, 0.999);
+        state.counters["max_ns"] =
+            latencies.empty() ? 0.0 : static_cast<double>(latencies.back());
+        state.counters["dropped"] = static_cast<double>(logger.droppedCount());
+        state.counters["stalls"] = static_cast<double>(stall_ends.size());
+        state.counters["recovery_avg_ms"] =
+            stall_ends.empty() ? 0.0 : recovery_sum / static_cast<double>(stall_ends.size());
+        state.counters["recovery_max_ms"] = recovery_max;
+    }
+}
+} // namespace
+
+BENCHMARK(slowSinkBenchmark)
+    ->ArgNames({"rate", "lat_ns", "stall_ms", "period_ms", "cap_Bps"})
+    ->Args({200000, 0, 0, 0, 0})                // healthy sink
+    ->Args({200000, 2000, 0, 0, 0})             // 2 us per write
+    ->Args({200000, 0, 50, 500, 0})             // fsync hiccups
+    ->Args({200000, 0, 500, 2000, 0})           // NFS hiccup
+    ->Args({200000, 0, 0, 0, 8 * 1024 * 1024})  // 8 MiB/s disk
+    ->Args({200000, 0, 50, 500, 16 * 1024 * 1024})
+    ->Iterations(1)
+    ->UseRealTime()
+    ->Unit(benchmark::kMillisecond);
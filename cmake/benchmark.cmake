@@ -9,4 +9,46 @@ FetchContent_MakeAvailable(benchmark)
 # Create benchmark executable
 file(GLOB_RECURSE BenchmarkFiles CONFIGURE_DEPENDS "${CMAKE_CURRENT_SOURCE_DIR}/benchmark/*.cpp")
 add_executable(benchmarks ${BenchmarkFiles})
-target_link_libraries(benchmarks PRIVATE benchmark::benchmark zerg)
\ No newline at end of file
+target_link_libraries(benchmarks PRIVATE benchmark::benchmark zerg)
+
+# Standalone queue benchmark (core-to-core latency matrix and throughput)
+add_executable(queue_benchmark ${CMAKE_CURRENT_SOURCE_DIR}/src/lock_free_queue.cpp)
+target_link_libraries(queue_benchmark PRIVATE pthread)
+
+# Perf regression check against a stored baseline
+#   cmake --build . --target bench-baseline   record the baseline on this machine
+#   cmake --build . --target bench-compare    rerun and fail on regressions
+find_package(Python3 COMPONENTS Interpreter)
+if(Python3_FOUND)
+    set(ZERG_BENCH_BASELINE "${CMAKE_CURRENT_SOURCE_DIR}/benchmark/baseline.json"
+        CACHE FILEPATH "Stored benchmark baseline for bench-compare")
+    set(ZERG_BENCH_FILTER "^logger_benchmark" CACHE STRING "Benchmarks checked by bench-compare")
+    set(ZERG_BENCH_REPETITIONS 10 CACHE STRING "Repetitions per benchmark for median/MAD")
+    set(ZERG_BENCH_THRESHOLD 0.05 CACHE STRING "Relative slowdown reported as a regression")
+
+    set(BENCH_COMPARE ${Python3_EXECUTABLE} ${CMAKE_CURRENT_SOURCE_DIR}/tools/bench_compare.py)
+
+    add_custom_target(bench-baseline
+        COMMAND ${BENCH_COMPARE} run
+                --benchmark $<TARGET_FILE:benchmarks>
+                --filter ${ZERG_BENCH_FILTER}
+                --repetitions ${ZERG_BENCH_REPETITIONS}
+                --out ${ZERG_BENCH_BASELINE}
+        DEPENDS benchmarks
+        COMMENT "Recording benchmark baseline ${ZERG_BENCH_BASELINE}"
+        USES_TERMINAL
+    )
+
+    add_custom_target(bench-compare
+        COMMAND ${BENCH_COMPARE} check
+                --benchmark $<TARGET_FILE:benchmarks>
+                --filter ${ZERG_BENCH_FILTER}
+                --repetitions ${ZERG_BENCH_REPETITIONS}
+                --threshold ${ZERG_BENCH_THRESHOLD}
+                --baseline ${ZERG_BENCH_BASELINE}
+                --out ${CMAKE_BINARY_DIR}/bench_current.json
+        DEPENDS benchmarks
+        COMMENT "Comparing benchmarks against ${ZERG_BENCH_BASELINE}"
+        USES_TERMINAL
+    )
+endif()
@@ -0,0 +1,20 @@
+# Command line tools shipped next to the library
+#   zerg-merge    k-way merge of per-thread / per-node log files by timestamp
+#   zerg-grep     time range extraction through the FileLogBackend sidecar index
+#   zerg-search   token search across segments, skipping those their bloom filter rules out
+#   zerg-columnar columnar export of a log segment and column-only aggregation queries
+#   zerg-tail     follows the active file through rotation, printing complete records only
+add_executable(zerg-merge ${CMAKE_CURRENT_SOURCE_DIR}/tools/zerg_merge.cpp)
+add_executable(zerg-grep ${CMAKE_CURRENT_SOURCE_DIR}/tools/zerg_grep.cpp)
+add_executable(zerg-search ${CMAKE_CURRENT_SOURCE_DIR}/tools/zerg_search.cpp)
+add_executable(zerg-columnar ${CMAKE_CURRENT_SOURCE_DIR}/tools/zerg_columnar.cpp)
+add_executable(zerg-tail ${CMAKE_CURRENT_SOURCE_DIR}/tools/zerg_tail.cpp)
+
+# tests/zerg_{merge,grep,search,columnar,tail}_tests.cpp run the tools
+add_dependencies(zerg_gtests zerg-merge zerg-grep zerg-search zerg-columnar zerg-tail)
+target_compile_definitions(zerg_gtests PRIVATE
+    ZERG_MERGE_PATH="$<TARGET_FILE:zerg-merge>"
+    ZERG_GREP_PATH="$<TARGET_FILE:zerg-grep>"
+    ZERG_SEARCH_PATH="$<TARGET_FILE:zerg-search>"
+    ZERG_COLUMNAR_PATH="$<TARGET_FILE:zerg-columnar>"
+    ZERG_TAIL_PATH="$<TARGET_FILE:zerg-tail>")
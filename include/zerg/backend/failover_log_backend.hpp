@@ -0,0 +1,351 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FAILOVER_LOG_BACKEND_HPP
+#define FAILOVER_LOG_BACKEND_HPP
+
+#include <atomic>             // std::atomic
+#include <chrono>             // std::chrono::steady_clock, std::chrono::milliseconds
+#include <condition_variable> // std::condition_variable
+#include <cstdint>            // std::uint8_t
+#include <memory>             // std::unique_ptr, std::shared_ptr
+#include <mutex>              // std::mutex, std::unique_lock
+#include <string>             // std::string
+#include <thread>             // std::thread
+#include <vector>             // std::vector
+#include "ilog_backend.hpp"   // ILogBackend, RecordInfo
+#include "../constants.hpp"   // FAILOVER_DEADLINE_MS, FAILOVER_RETRY_MS, FAILOVER_BATCH_SIZE
+
+namespace zerg
+{
+
+/*
+ * Watchdog around a sink that can hang (stuck NFS mount, blocked pipe)
+ * The primary is only ever called from an I/O thread of its own. Calls are staged and
+ * handed over in batches (FAILOVER_BATCH_SIZE, or at flush / rotate / reopen), and the
+ * logger's backend thread waits for each batch at most `deadline`. A batch that misses the
+ * deadline, or leaves the primary reporting an error, is written to the secondary (a local
+ * FileLogBackend or a RingLogBackend) and so is everything after it, while the I/O thread
+ * stays stuck in the primary without holding any of the logger's locks.
+ * Every `retry` the primary is probed, once its hung call has returned: a flush, or a
+ * reopen after an error, that completes within the deadline switches back.
+ * Records of the failing batch may reach both sinks; records written during the failover
+ * stay in the secondary.
+ */
+class FailoverLogBackend : public ILogBackend
+{
+  public:
+    FailoverLogBackend(std::unique_ptr<ILogBackend> primary,
+                       std::unique_ptr<ILogBackend> secondary,
+                       const std::chrono::milliseconds deadline =
+                           std::chrono::milliseconds(FAILOVER_DEADLINE_MS),
+                       const std::chrono::milliseconds retry =
+                           std::chrono::milliseconds(FAILOVER_RETRY_MS))
+        : _secondary(std::move(secondary)), _deadline(deadline), _retry(retry),
+          _channel(std::make_shared<Channel>())
+    {
+        _channel->primary = std::move(primary);
+        _worker = std::thread(&FailoverLogBackend::workerLoop, _channel);
+    }
+
+    ~FailoverLogBackend() override
+    {
+        flush();
+        std::unique_lock<std::mutex> lock(_channel->mutex);
+        _channel->stop = true;
+        _channel->cv.notify_all();
+        // a worker stuck in the primary owns the channel from here on and is left behind
+        if (_channel->cv.wait_for(lock, _deadline, [this] { return _channel->exited; }))
+        {
+            lock.unlock();
+            _worker.join();
+        }
+        else
+        {
+            lock.unlock();
+            _worker.detach();
+        }
+    }
+
+    FailoverLogBackend(const FailoverLogBackend &) = delete;
+    FailoverLogBackend &operator=(const FailoverLogBackend &) = delete;
+
+    void write(const char *data, std::streamsize size) override
+    {
+        if (primaryActive())
+            stage(Op::WRITE, data, static_cast<std::size_t>(size));
+        else
+            _secondary->write(data, size);
+    }
+    void writeNewline() override
+    {
+        if (primaryActive())
+            stage(Op::NEWLINE, nullptr, 0);
+        else
+            _secondary->writeNewline();
+    }
+    void writeRecord(const char *data, std::streamsize size, const RecordInfo &info) override
+    {
+        if (primaryActive())
+            stage(Op::RECORD, data, static_cast<std::size_t>(size), info);
+        else
+            _secondary->writeRecord(data, size, info);
+    }
+    void flush() override
+    {
+        if (!primaryActive())
+        {
+            _secondary->flush();
+            return;
+        }
+        stage(Op::FLUSH, nullptr, 0);
+        submit();
+    }
+    void reopen() override
+    {
+        if (!primaryActive())
+        {
+            _secondary->reopen();
+            return;
+        }
+        stage(Op::REOPEN, nullptr, 0);
+        submit();
+    }
+    bool rotate() override
+    {
+        if (!primaryActive())
+            return _secondary->rotate();
+        stage(Op::ROTATE, nullptr, 0);
+        return submit();
+    }
+    bool good() const override
+    {
+        if (_failed_over.load(std::memory_order_relaxed))
+            return _secondary->good();
+        return _channel->good.load(std::memory_order_relaxed);
+    }
+
+    // writing to the secondary right now
+    [[nodiscard]] bool failedOver() const { return _failed_over.load(std::memory_order_relaxed); }
+    [[nodiscard]] std::size_t failovers() const
+    {
+        return _failovers.load(std::memory_order_relaxed);
+    }
+
+  private:
+    struct Op
+    {
+        enum Kind : std::uint8_t
+        {
+            RECORD,
+            WRITE,
+            NEWLINE,
+            FLUSH,
+            ROTATE,
+            REOPEN,
+        };
+        Kind kind;
+        std::size_t begin;
+        std::size_t end;
+        RecordInfo info;
+    };
+
+    struct Batch
+    {
+        std::string data;
+        std::vector<Op> ops;
+
+        void clear()
+        {
+            data.clear();
+            ops.clear();
+        }
+    };
+
+    // shared with the I/O thread, which outlives the backend if the primary never returns
+    struct Channel
+    {
+        std::mutex mutex;
+        std::condition_variable cv;
+        std::unique_ptr<ILogBackend> primary; // I/O thread only
+        Batch batch;
+        bool pending{false};
+        bool stop{false};
+        bool exited{false};
+        bool rotated{false};
+        std::atomic<bool> busy{false}; // from hand over until the primary returned
+        std::atomic<bool> good{true};
+    };
+
+    // returns whether the batch rotated the backend
+    static bool replay(const Batch &batch, ILogBackend &backend)
+    {
+        bool rotated = false;
+        for (const auto &op : batch.ops)
+        {
+            const char *data = batch.data.data() + op.begin;
+            const auto size = static_cast<std::streamsize>(op.end - op.begin);
+            switch (op.kind)
+            {
+            case Op::RECORD:
+                backend.writeRecord(data, size, op.info);
+                break;
+            case Op::WRITE:
+                backend.write(data, size);
+                break;
+            case Op::NEWLINE:
+                backend.writeNewline();
+                break;
+            case Op::FLUSH:
+                backend.flush();
+                break;
+            case Op::ROTATE:
+                rotated = backend.rotate() || rotated;
+                break;
+            case Op::REOPEN:
+                backend.reopen();
+                break;
+            }
+        }
+        return rotated;
+    }
+
+    static void workerLoop(const std::shared_ptr<Channel> channel)
+    {
+        std::unique_lock<std::mutex> lock(channel->mutex);
+        for (;;)
+        {
+            channel->cv.wait(lock, [&] { return channel->pending || channel->stop; });
+            if (!channel->pending)
+                break;
+            lock.unlock();
+            // the backend thread only reads the batch meanwhile, and only under the lock
+            const bool rotated = replay(channel->batch, *channel->primary);
+            const bool good = channel->primary->good();
+            lock.lock();
+            channel->rotated = rotated;
+            channel->good.store(good, std::memory_order_relaxed);
+            channel->pending = false;
+            channel->busy.store(false, std::memory_order_release);
+            channel->cv.notify_all();
+        }
+        // closing the primary can hang just the same
+        lock.unlock();
+        channel->primary.reset();
+        lock.lock();
+        channel->exited = true;
+        channel->cv.notify_all();
+    }
+
+    void stage(const Op::Kind kind, const char *data, const std::size_t size,
+               const RecordInfo &info = {})
+    {
+        const std::size_t begin = _staged.data.size();
+        _staged.data.append(data, size);
+        _staged.ops.push_back({kind, begin, _staged.data.size(), info});
+        if (_staged.data.size() >= FAILOVER_BATCH_SIZE)
+            submit();
+    }
+
+    // hand the staged calls to the primary, on failure replay them on the secondary.
+    // Returns whether they rotated the backend
+    bool submit()
+    {
+        if (_staged.ops.empty())
+            return false;
+        bool rotated = false;
+        if (runOnPrimary(rotated))
+        {
+            _staged.clear();
+            return rotated;
+        }
+        rotated = replay(_staged, *_secondary);
+        _staged.clear();
+        _failovers.fetch_add(1, std::memory_order_relaxed);
+        _failed_over.store(true, std::memory_order_relaxed);
+        _retry_at = std::chrono::steady_clock::now() + _retry;
+        return rotated;
+    }
+
+    // true if the primary took the staged calls within the deadline and reports no error,
+    // otherwise _staged still holds them
+    bool runOnPrimary(bool &rotated)
+    {
+        std::unique_lock<std::mutex> lock(_channel->mutex);
+        std::swap(_channel->batch, _staged);
+        _staged.clear();
+        _channel->pending = true;
+        _channel->busy.store(true, std::memory_order_relaxed);
+        _channel->cv.notify_all();
+        const bool done =
+            _channel->cv.wait_for(lock, _deadline, [this] { return !_channel->pending; });
+        if (done && _channel->good.load(std::memory_order_relaxed))
+        {
+            rotated = _channel->rotated;
+            return true;
+        }
+        // still being read by a hung worker: copy, the worker's batch is reused only
+        // once it has returned
+        _staged = _channel->batch;
+        return false;
+    }
+
+    // false while failed over, probes the primary once it may have recovered
+    bool primaryActive()
+    {
+        if (!_failed_over.load(std::memory_order_relaxed))
+            return true;
+        if (_channel->busy.load(std::memory_order_acquire) ||
+            std::chrono::steady_clock::now() < _retry_at)
+        {
+            return false;
+        }
+        stage(_channel->good.load(std::memory_order_relaxed) ? Op::FLUSH : Op::REOPEN, nullptr,
+              0);
+        bool rotated = false;
+        if (runOnPrimary(rotated))
+        {
+            // what was written during the failover must not wait in the secondary's buffer
+            // for the next failover or its destructor
+            _secondary->flush();
+            _failed_over.store(false, std::memory_order_relaxed);
+        }
+        else
+        {
+            _retry_at = std::chrono::steady_clock::now() + _retry;
+        }
+        _staged.clear();
+        return !_failed_over.load(std::memory_order_relaxed);
+    }
+
+    std::unique_ptr<ILogBackend> _secondary;
+    const std::chrono::milliseconds _deadline;
+    const std::chrono::milliseconds _retry;
+    std::shared_ptr<Channel> _channel;
+    std::thread _worker;
+    Batch _staged; // backend thread only
+    std::atomic<bool> _failed_over{false};
+    std::atomic<std::size_t> _failovers{0};
+    std::chrono::steady_clock::time_point _retry_at;
+};
+
+} // namespace zerg
+
+#endif // FAILOVER_LOG_BACKEND_HPP
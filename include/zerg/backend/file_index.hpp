@@ -0,0 +1,141 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FILE_INDEX_HPP
+#define FILE_INDEX_HPP
+
+#include <algorithm> // std::upper_bound
+#include <cstdint>   // std::int64_t, std::uint64_t, std::uint32_t
+#include <cstring>   // std::memcmp
+#include <fstream>   // std::ifstream, std::ofstream
+#include <stdexcept> // std::runtime_error
+#include <string>    // std::string
+#include <vector>    // std::vector
+
+namespace zerg
+{
+
+/*
+ * Sparse time index written next to a log file as "<log>.idx"
+ * Header: "ZIDX", uint32 version, uint32 entry size, then fixed size entries, one per
+ * INDEX_INTERVAL_BYTES of log: the first record of that stretch, its byte offset and its
+ * sequence number. Entries are appended as the log grows, a reader binary searches them by
+ * time and only scans the stretches that can hold the range.
+ */
+struct FileIndexEntry
+{
+    std::int64_t timestamp_ns;
+    std::uint64_t offset;
+    std::uint64_t sequence;
+};
+
+namespace file_index_detail
+{
+constexpr char MAGIC[4] = {'Z', 'I', 'D', 'X'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::size_t HEADER_SIZE = sizeof(MAGIC) + 2 * sizeof(std::uint32_t);
+} // namespace file_index_detail
+
+inline std::string fileIndexPath(const std::string &log_path) { return log_path + ".idx"; }
+
+class FileIndexWriter
+{
+  public:
+    // fresh = the log is empty, so any stale index is discarded
+    void open(const std::string &path, const bool fresh)
+    {
+        _ofs.open(path, std::ios::binary | (fresh ? std::ios::trunc : std::ios::app));
+        if (_ofs.tellp() == 0)
+        {
+            const std::uint32_t header[2] = {file_index_detail::VERSION,
+                                             static_cast<std::uint32_t>(sizeof(FileIndexEntry))};
+            _ofs.write(file_index_detail::MAGIC, sizeof(file_index_detail::MAGIC));
+            _ofs.write(reinterpret_cast<const char *>(header), sizeof(header));
+        }
+    }
+
+    [[nodiscard]] bool isOpen() const { return _ofs.is_open(); }
+
+    void append(const FileIndexEntry &entry)
+    {
+        _ofs.write(reinterpret_cast<const char *>(&entry), sizeof(entry));
+    }
+
+    void flush() { _ofs.flush(); }
+
+  private:
+    std::ofstream _ofs;
+};
+
+// whole index, empty when there is none. Throws std::runtime_error on a foreign file
+inline std::vector<FileIndexEntry> readFileIndex(const std::string &path)
+{
+    std::vector<FileIndexEntry> entries;
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+        return entries;
+
+    char magic[sizeof(file_index_detail::MAGIC)];
+    std::uint32_t header[2];
+    if (!in.read(magic, sizeof(magic)) ||
+        !in.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+        std::memcmp(magic, file_index_detail::MAGIC, sizeof(magic)) != 0 ||
+        header[0] != file_index_detail::VERSION || header[1] != sizeof(FileIndexEntry))
+    {
+        throw std::runtime_error("Not a zerg index: " + path);
+    }
+    FileIndexEntry entry;
+    // a torn last entry (crash while appending) is ignored
+    while (in.read(reinterpret_cast<char *>(&entry), sizeof(entry)))
+        entries.push_back(entry);
+    return entries;
+}
+
+// byte offset where a scan for records at or after timestamp_ns has to start. The index
+// entry before the first one past timestamp_ns is taken, plus one more for records stamped
+// slightly out of order by concurrent producers
+inline std::uint64_t indexStartOffset(const std::vector<FileIndexEntry> &entries,
+                                      const std::int64_t timestamp_ns)
+{
+    auto it = std::upper_bound(
+        entries.begin(), entries.end(), timestamp_ns,
+        [](const std::int64_t ts, const FileIndexEntry &e) { return ts < e.timestamp_ns; });
+    for (int back = 0; back < 2 && it != entries.begin(); ++back)
+        --it;
+    // an index opened on a file that already held records has no entry for them
+    return it == entries.begin() ? 0 : it->offset;
+}
+
+// byte offset after which no record later than timestamp_ns starts (with the same slack),
+// UINT64_MAX = end of file
+inline std::uint64_t indexEndOffset(const std::vector<FileIndexEntry> &entries,
+                                    const std::int64_t timestamp_ns)
+{
+    auto it = std::upper_bound(
+        entries.begin(), entries.end(), timestamp_ns,
+        [](const std::int64_t ts, const FileIndexEntry &e) { return ts < e.timestamp_ns; });
+    if (it != entries.end())
+        ++it;
+    return it == entries.end() ? UINT64_MAX : it->offset;
+}
+
+} // namespace zerg
+
+#endif // FILE_INDEX_HPP
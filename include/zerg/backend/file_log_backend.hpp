@@ -21,32 +21,366 @@
 #ifndef FILE_LOG_BACKEND_HPP
 #define FILE_LOG_BACKEND_HPP
 
+#include <algorithm>        // std::max
+#include <cerrno>           // errno, EINTR
+#include <cstdint>          // INT64_MIN
+#include <cstdio>           // std::rename
+#include <fcntl.h>          // open, O_APPEND
 #include <fstream>          // std::ofstream
+#include <stdexcept>        // std::runtime_error
+#include <sys/file.h>       // flock
+#include <sys/stat.h>       // stat, S_ISREG
+#include <time.h>           // clock_gettime
+#include <unistd.h>         // write, close
 #include "ilog_backend.hpp" // ILogBackend
-#include "../constants.hpp" // DEFAULT_BUFFER_SIZE
+#include "file_index.hpp"   // FileIndexWriter
+#include "token_bloom.hpp"  // TokenBloomFilter
+#include "record_frame.hpp" // frameTrailer, recoverFramedLog
+#include "log_segment.hpp"  // rotatedSegmentPath
+#include <memory>           // std::unique_ptr
+#include <string>           // std::string
+#include "../constants.hpp" // DEFAULT_BUFFER_SIZE, INDEX_INTERVAL_BYTES
 
 namespace zerg
 {
+
+struct FileLogOptions
+{
+    // Sidecars for the search tools, off by default. The index costs 24 bytes per
+    // index_interval, the bloom filter bloom_bits / 8 bytes of memory per open segment and
+    // tokenizing and hashing every record on the backend thread
+    // maintain "<filename>.idx" (see file_index.hpp, zerg-grep), regular files only
+    bool index = false;
+    std::size_t index_interval = INDEX_INTERVAL_BYTES;
+    // maintain "<filename>.bloom" of record tokens (see token_bloom.hpp, zerg-search), saved
+    // on close
+    bool bloom = false;
+    std::uint64_t bloom_bits = BLOOM_FILTER_BITS;
+    // end every record with a CRC32C trailer (see record_frame.hpp) and truncate a torn
+    // tail on open
+    bool framing = false;
+    // Several processes append to the same file: raw O_APPEND descriptor instead of the
+    // ofstream, each batch of whole records goes out in one write of at most
+    // append_atomic_size bytes, so records of different processes never interleave.
+    // A record larger than that is written on its own under an exclusive flock.
+    // The file is shared, so no index or bloom filter is kept
+    bool shared_append = false;
+    std::size_t append_atomic_size = APPEND_ATOMIC_SIZE;
+};
+
 class FileLogBackend : public ILogBackend
 {
   public:
-    explicit FileLogBackend(const std::string &filename)
+    explicit FileLogBackend(const std::string &filename, const FileLogOptions &options = {})
+        : _filename(filename), _options(options), _index_interval(options.index_interval),
+          _framing(options.framing), _atomic_size(options.append_atomic_size)
     {
-        _ofs.open(filename, std::ios::out | std::ios::app);
-        static char fileBuffer[DEFAULT_BUFFER_SIZE];
-        _ofs.rdbuf()->pubsetbuf(fileBuffer, sizeof(fileBuffer));
+        open();
+        if (_options.shared_append && _fd < 0)
+            throw std::runtime_error("Cannot open log file: " + filename);
     }
     ~FileLogBackend() override
     {
+        if (_options.shared_append)
+        {
+            flushBatch(_batch.size());
+            if (_fd >= 0)
+                ::close(_fd);
+        }
         if (_ofs.is_open())
             _ofs.close();
+        saveBloom();
+    }
+    void write(const char *data, std::streamsize size) override
+    {
+        if (_options.shared_append)
+        {
+            _batch.append(data, static_cast<std::size_t>(size));
+            return;
+        }
+        _ofs.write(data, size);
+        _offset += static_cast<std::uint64_t>(size);
+    }
+    void writeNewline() override
+    {
+        if (_options.shared_append)
+        {
+            _batch.push_back('\n');
+            endRecord();
+            return;
+        }
+        _ofs.put('\n');
+        ++_offset;
+    }
+    void writeRecord(const char *data, std::streamsize size, const RecordInfo &info) override
+    {
+        if (_index.isOpen() && _offset >= _next_index)
+        {
+            // 24 bytes per interval, the log itself is the only other write. Chunks written by
+            // sync() on the caller can land slightly out of order, clamping keeps the index
+            // sorted for binary search (readers scan one stretch either side anyway)
+            _index_time = std::max(_index_time, info.timestamp_ns);
+            _index.append({_index_time, _offset, info.sequence});
+            _next_index = _offset + _index_interval;
+        }
+        if (_bloom)
+            _bloom->addTokens(data, static_cast<std::size_t>(size));
+        write(data, size);
+        if (_framing)
+        {
+            const auto trailer = frameTrailer(data, static_cast<std::size_t>(size));
+            write(trailer.data(), static_cast<std::streamsize>(trailer.size()));
+        }
+        writeNewline();
+    }
+    void flush() override
+    {
+        if (_options.shared_append)
+        {
+            // complete records only, a record still being written waits for its newline
+            flushBatch(_record_start);
+            return;
+        }
+        // log first, an index entry must never point past the data on disk
+        _ofs.flush();
+        if (_index.isOpen())
+            _index.flush();
+    }
+    // The stream sets badbit when a write or flush fails (ENOSPC, EIO); the raw descriptor
+    // keeps the unwritten part of the batch instead and retries it after reopen()
+    bool good() const override
+    {
+        if (_options.shared_append)
+            return _fd >= 0 && !_failed;
+        return _ofs.good();
+    }
+
+    // Close and reopen the path, for external rotation (logrotate renames the file, then
+    // signals). Everything written so far goes to the old file, everything after to the new
+    // one. The sidecars of the renamed file keep their old names and are overwritten by the
+    // new file's, so the old bloom filter is dropped rather than saved
+    void reopen() override
+    {
+        if (_options.shared_append)
+        {
+            // a record still missing its newline continues in the new file
+            flushBatch(_record_start);
+            if (_fd >= 0)
+                ::close(_fd);
+            _fd = -1;
+        }
+        if (_ofs.is_open())
+            _ofs.close();
+        _index = FileIndexWriter{};
+        _bloom.reset();
+        _offset = 0;
+        _next_index = 0;
+        _index_time = INT64_MIN;
+        reopenFile();
     }
-    void write(const char *data, std::streamsize size) override { _ofs.write(data, size); }
-    void writeNewline() override { _ofs.put('\n'); }
-    void flush() override { _ofs.flush(); }
+
+    // The file and its sidecars become "<filename>.<UTC timestamp>" (see log_segment.hpp)
+    // and a new file is started. A shared file is not rotated here, other processes would
+    // keep appending to the renamed one: rotate it from outside and use requestReopen()
+    bool rotate() override
+    {
+        if (_options.shared_append)
+            return false;
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        const std::string segment = rotatedSegmentPath(
+            _filename, static_cast<std::int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec);
+
+        _ofs.close();
+        _index = FileIndexWriter{};
+        saveBloom();
+        const bool rotated = std::rename(_filename.c_str(), segment.c_str()) == 0;
+        if (rotated)
+        {
+            // a sidecar left behind only costs a full scan of the segment
+            static_cast<void>(
+                std::rename(fileIndexPath(_filename).c_str(), fileIndexPath(segment).c_str()));
+            static_cast<void>(
+                std::rename(tokenBloomPath(_filename).c_str(), tokenBloomPath(segment).c_str()));
+        }
+        // if the rename failed this appends to the same file again, sidecars included
+        _bloom.reset();
+        _offset = 0;
+        _next_index = 0;
+        _index_time = INT64_MIN;
+        reopenFile();
+        return rotated;
+    }
+
+    // bytes of torn or corrupt records cut from the end when the file was opened
+    [[nodiscard]] std::uint64_t recoveredBytes() const { return _recovered_bytes; }
 
   private:
+    void open()
+    {
+        // before anything looks at the size, the torn tail of a crash is not part of the log.
+        // Never on a shared file, another process may be appending to it right now
+        if (_framing && !_options.shared_append)
+            _recovered_bytes = recoverFramedLog(_filename);
+        if (_options.shared_append)
+        {
+            _fd = ::open(_filename.c_str(), O_WRONLY | O_APPEND | O_CREAT | O_CLOEXEC, 0644);
+            _failed = _fd < 0;
+            _batch.reserve(_atomic_size);
+            return;
+        }
+        _ofs.open(_filename, std::ios::out | std::ios::app);
+        static char fileBuffer[DEFAULT_BUFFER_SIZE];
+        _ofs.rdbuf()->pubsetbuf(fileBuffer, sizeof(fileBuffer));
+
+        struct stat st{};
+        if ((_options.index || _options.bloom) && ::stat(_filename.c_str(), &st) == 0 &&
+            S_ISREG(st.st_mode))
+        {
+            _offset = static_cast<std::uint64_t>(st.st_size);
+            _next_index = _offset;
+            if (_options.index)
+                _index.open(fileIndexPath(_filename), _offset == 0);
+            if (_options.bloom)
+                openBloom(_options.bloom_bits);
+        }
+    }
+
+    // open() again from reopen() or rotate(), which run on the logger's backend thread.
+    // A failure there (the torn tail cannot be cut, a foreign index next to it) leaves the
+    // backend not good(), the logger degrades and probes with reopen() until it opens
+    void reopenFile() noexcept
+    {
+        try
+        {
+            open();
+        }
+        catch (const std::exception &)
+        {
+            if (_options.shared_append)
+                _failed = true;
+            else
+                _ofs.setstate(std::ios::badbit);
+        }
+    }
+
+    // the record that just got its newline starts at _record_start
+    void endRecord()
+    {
+        const std::size_t record = _batch.size() - _record_start;
+        if (record > _atomic_size)
+        {
+            flushBatch(_record_start);
+            // after a failed write the batch still holds older records, they go first
+            if (_record_start == 0)
+                _batch.erase(0, writeLarge(_batch.data(), _batch.size()));
+        }
+        else if (_batch.size() > _atomic_size)
+        {
+            // the batch is full without this record, it opens the next one
+            flushBatch(_record_start);
+        }
+        _record_start = _batch.size();
+    }
+
+    // one write of whole records: O_APPEND places it at the end of the file atomically.
+    // What the kernel did not take stays in the batch
+    void flushBatch(const std::size_t size)
+    {
+        if (size != 0)
+        {
+            const std::size_t written = writeAll(_batch.data(), size);
+            _batch.erase(0, written);
+            _record_start -= std::min(_record_start, written);
+        }
+    }
+
+    // On its own and still one write, which a local filesystem does not interleave with other
+    // appends. Should the kernel return short (signal, quota), the lock at least keeps the
+    // large records of cooperating processes from being spliced into each other
+    std::size_t writeLarge(const char *data, const std::size_t size)
+    {
+        ::flock(_fd, LOCK_EX);
+        const std::size_t written = writeAll(data, size);
+        ::flock(_fd, LOCK_UN);
+        return written;
+    }
+
+    // bytes written, short on an error, which good() then reports to the logger
+    std::size_t writeAll(const char *data, const std::size_t size)
+    {
+        std::size_t done = 0;
+        while (done < size)
+        {
+            const ssize_t written = ::write(_fd, data + done, size - done);
+            if (written < 0)
+            {
+                if (errno == EINTR)
+                    continue;
+                _failed = true;
+                break;
+            }
+            done += static_cast<std::size_t>(written);
+        }
+        return done;
+    }
+
+    void openBloom(const std::uint64_t bits)
+    {
+        _bloom = std::make_unique<TokenBloomFilter>(bits);
+        if (_offset == 0)
+            return;
+        // appending to an existing segment: keep what its filter already knows
+        try
+        {
+            auto existing = TokenBloomFilter::load(tokenBloomPath(_filename));
+            if (existing.coveredBytes() == _offset)
+            {
+                existing.expand(bits);
+                *_bloom = std::move(existing);
+                return;
+            }
+        }
+        catch (const std::runtime_error &)
+        {
+        }
+        // no usable filter for the old data, never write one that would claim to cover it
+        _bloom.reset();
+    }
+
+    void saveBloom() noexcept
+    {
+        if (!_bloom)
+            return;
+        try
+        {
+            _bloom->compact();
+            _bloom->setCoveredBytes(_offset);
+            _bloom->save(tokenBloomPath(_filename));
+        }
+        catch (const std::exception &)
+        {
+            // a missing filter only costs a full scan of this segment
+        }
+    }
+
+    std::string _filename;
+    FileLogOptions _options;
     std::ofstream _ofs;
+    std::unique_ptr<TokenBloomFilter> _bloom;
+    FileIndexWriter _index;
+    std::uint64_t _offset{};
+    std::uint64_t _next_index{};
+    std::int64_t _index_time{INT64_MIN};
+    std::size_t _index_interval;
+    bool _framing;
+    std::uint64_t _recovered_bytes{};
+    // shared_append
+    int _fd{-1};
+    std::size_t _atomic_size;
+    std::string _batch;
+    std::size_t _record_start{0};
+    bool _failed{false};
 };
 } // namespace zerg
 
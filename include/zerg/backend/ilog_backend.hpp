@@ -21,11 +21,19 @@
 #ifndef ILOG_BACKEND_HPP
 #define ILOG_BACKEND_HPP
 
-#include <ios> // std::streamsize
+#include <ios>     // std::streamsize
+#include <cstdint> // std::int64_t, std::uint64_t
 
 namespace zerg
 {
 
+// what the logger knows about a record besides its text
+struct RecordInfo
+{
+    std::int64_t timestamp_ns{}; // wall clock, nanoseconds since the epoch
+    std::uint64_t sequence{};    // per-logger sequence (queue ticket)
+};
+
 // Interface for log backends
 // TODO Multiple backends i.e console, network
 class ILogBackend
@@ -35,6 +43,25 @@ class ILogBackend
     virtual void write(const char *data, std::streamsize size) = 0;
     virtual void writeNewline() = 0;
     virtual void flush() = 0;
+
+    // reopen the destination after external rotation (see requestReopen), no-op by default
+    virtual void reopen() {}
+
+    // size based rotation: keep what was written so far as a segment and start a new
+    // destination. False if nothing was rotated, the default
+    virtual bool rotate() { return false; }
+
+    // false once a write or flush failed (disk full, I/O error) until a reopen() succeeds,
+    // the logger then degrades and probes with reopen()
+    virtual bool good() const { return true; }
+
+    // one formatted record without its newline, backends that index or frame records
+    // override this, the rest get plain write() + writeNewline()
+    virtual void writeRecord(const char *data, std::streamsize size, const RecordInfo &)
+    {
+        write(data, size);
+        writeNewline();
+    }
 };
 } // namespace zerg
 
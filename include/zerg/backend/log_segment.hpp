@@ -0,0 +1,77 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef LOG_SEGMENT_HPP
+#define LOG_SEGMENT_HPP
+
+#include <cctype>  // std::isdigit
+#include <cstdint> // std::int64_t
+#include <cstdio>  // std::snprintf
+#include <ctime>   // gmtime_r, std::strftime
+#include <string>  // std::string
+
+namespace zerg
+{
+
+namespace log_segment_detail
+{
+// "YYYYmmddTHHMMSS.nnnnnnnnn", UTC
+constexpr char PATTERN[] = "00000000T000000.000000000";
+constexpr std::size_t SUFFIX_SIZE = sizeof(PATTERN) - 1;
+} // namespace log_segment_detail
+
+// Name a size rotated segment of log_path gets: "<log_path>.<UTC time to the nanosecond>".
+// Names of one log sort by age, so retention and the search tools need no metadata
+inline std::string rotatedSegmentPath(const std::string &log_path, const std::int64_t time_ns)
+{
+    const time_t seconds = static_cast<time_t>(time_ns / 1000000000LL);
+    std::tm tm_time{};
+    gmtime_r(&seconds, &tm_time);
+    char suffix[log_segment_detail::SUFFIX_SIZE + 1];
+    const std::size_t date = std::strftime(suffix, sizeof(suffix), "%Y%m%dT%H%M%S", &tm_time);
+    std::snprintf(suffix + date, sizeof(suffix) - date, ".%09lld",
+                  static_cast<long long>(time_ns % 1000000000LL));
+    return log_path + "." + suffix;
+}
+
+// true if name (no directory) is a rotated segment of the log called base (no directory),
+// not one of its sidecars
+inline bool isRotatedSegment(const std::string &name, const std::string &base)
+{
+    using log_segment_detail::PATTERN;
+    if (name.size() != base.size() + 1 + log_segment_detail::SUFFIX_SIZE ||
+        name.compare(0, base.size(), base) != 0 || name[base.size()] != '.')
+    {
+        return false;
+    }
+    for (std::size_t i = 0; i < log_segment_detail::SUFFIX_SIZE; ++i)
+    {
+        const char c = name[base.size() + 1 + i];
+        const bool ok = PATTERN[i] == '0' ? std::isdigit(static_cast<unsigned char>(c)) != 0
+                                          : c == PATTERN[i];
+        if (!ok)
+            return false;
+    }
+    return true;
+}
+
+} // namespace zerg
+
+#endif // LOG_SEGMENT_HPP
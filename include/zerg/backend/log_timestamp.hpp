@@ -0,0 +1,101 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef LOG_TIMESTAMP_HPP
+#define LOG_TIMESTAMP_HPP
+
+#include <cstddef> // std::size_t
+#include <cstdint> // std::int64_t
+#include <cstdlib> // std::atoi
+#include <cstring> // std::memcmp, std::memcpy
+#include <ctime>   // std::tm, std::mktime
+
+namespace zerg
+{
+
+// length of the "YYYY-MM-DD HH:MM:SS" a record starts with
+constexpr std::size_t LOG_TIMESTAMP_SECONDS = 19;
+
+// true if text starts like a record: "YYYY-MM-DD HH:MM:SS"
+inline bool isLogTimestamp(const char *text, const std::size_t length)
+{
+    return length >= LOG_TIMESTAMP_SECONDS && text[4] == '-' && text[7] == '-' &&
+           text[10] == ' ' && text[13] == ':' && text[16] == ':';
+}
+
+/*
+ * Reads the "YYYY-MM-DD HH:MM:SS[.ffffff]" local time prefix the logger prints (any number
+ * of fraction digits, the fine timestamps have six) as ns since the epoch. Shared by the
+ * command line tools so they agree on the format. mktime is slow, consecutive records of
+ * the same second share one conversion.
+ */
+class LogTimestampParser
+{
+  public:
+    static constexpr std::int64_t NS_PER_SECOND = 1000000000LL;
+
+    // -1 if text does not start with a timestamp, end is set to the offset just past it
+    std::int64_t parse(const char *text, const std::size_t length, std::size_t &end)
+    {
+        if (!isLogTimestamp(text, length))
+            return -1;
+        if (_second_ns < 0 || std::memcmp(_second, text, LOG_TIMESTAMP_SECONDS) != 0)
+        {
+            std::tm tm_time{};
+            tm_time.tm_year = std::atoi(text) - 1900;
+            tm_time.tm_mon = std::atoi(text + 5) - 1;
+            tm_time.tm_mday = std::atoi(text + 8);
+            tm_time.tm_hour = std::atoi(text + 11);
+            tm_time.tm_min = std::atoi(text + 14);
+            tm_time.tm_sec = std::atoi(text + 17);
+            tm_time.tm_isdst = -1;
+            std::memcpy(_second, text, LOG_TIMESTAMP_SECONDS);
+            _second_ns = static_cast<std::int64_t>(std::mktime(&tm_time)) * NS_PER_SECOND;
+        }
+
+        std::int64_t ns = _second_ns;
+        end = LOG_TIMESTAMP_SECONDS;
+        if (length > end + 1 && text[end] == '.')
+        {
+            std::int64_t scale = NS_PER_SECOND / 10;
+            // digits past nanoseconds are skipped, not added
+            for (end += 1; end < length && text[end] >= '0' && text[end] <= '9'; ++end)
+            {
+                ns += (text[end] - '0') * scale;
+                scale /= 10;
+            }
+        }
+        return ns;
+    }
+
+    std::int64_t parse(const char *text, const std::size_t length)
+    {
+        std::size_t end = 0;
+        return parse(text, length, end);
+    }
+
+  private:
+    char _second[LOG_TIMESTAMP_SECONDS]{};
+    std::int64_t _second_ns{-1};
+};
+
+} // namespace zerg
+
+#endif // LOG_TIMESTAMP_HPP
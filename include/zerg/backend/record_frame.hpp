@@ -0,0 +1,250 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RECORD_FRAME_HPP
+#define RECORD_FRAME_HPP
+
+#include <array>            // std::array
+#include <cctype>           // std::isprint
+#include <cstdint>          // std::uint32_t, std::uint64_t
+#include <cstring>          // std::memchr
+#include <fcntl.h>          // open
+#include <stdexcept>        // std::runtime_error
+#include <string>           // std::string
+#include <sys/mman.h>       // mmap, munmap
+#include <sys/stat.h>       // fstat
+#include <unistd.h>         // close, truncate
+#include <vector>           // std::vector
+#include "../crc32c.hpp"    // crc32c
+#include "file_index.hpp"   // readFileIndex, FileIndexWriter
+
+namespace zerg
+{
+
+/*
+ * Record framing for crash consistent logs (FileLogOptions::framing)
+ * Records are single lines (the logger strips non-printable characters), so the frame is a
+ * trailer: the record text, " ~", the CRC32C of the text as 8 hex digits, '\n'. The line
+ * length is the record length, the checksum covers it, and the file stays readable by
+ * grep, zerg-tail and friends. A torn or corrupted record fails its checksum.
+ */
+// " ~" and eight hex digits
+constexpr std::size_t FRAME_TRAILER_SIZE = 10;
+
+namespace record_frame_detail
+{
+constexpr char TAG[2] = {' ', '~'};
+constexpr std::size_t CRC_DIGITS = 8;
+constexpr char HEX[] = "0123456789abcdef";
+
+inline int hexValue(const char c)
+{
+    if (c >= '0' && c <= '9')
+        return c - '0';
+    if (c >= 'a' && c <= 'f')
+        return c - 'a' + 10;
+    return -1;
+}
+
+// line ends in a trailer, whether or not its checksum matches
+inline bool hasTrailer(const char *line, const std::size_t size)
+{
+    if (size < FRAME_TRAILER_SIZE)
+        return false;
+    const char *trailer = line + size - FRAME_TRAILER_SIZE;
+    if (trailer[0] != TAG[0] || trailer[1] != TAG[1])
+        return false;
+    for (std::size_t i = sizeof(TAG); i < FRAME_TRAILER_SIZE; ++i)
+    {
+        if (hexValue(trailer[i]) < 0)
+            return false;
+    }
+    return true;
+}
+
+inline bool isPrintable(const char *line, const std::size_t size)
+{
+    for (std::size_t i = 0; i < size; ++i)
+    {
+        if (std::isprint(static_cast<unsigned char>(line[i])) == 0)
+            return false;
+    }
+    return true;
+}
+
+// read only mapping of a whole file, empty when the file is empty or missing
+class MappedFile
+{
+  public:
+    explicit MappedFile(const std::string &path)
+    {
+        const int fd = ::open(path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (fd < 0)
+            return;
+        struct stat st{};
+        if (::fstat(fd, &st) == 0 && st.st_size > 0)
+        {
+            const auto size = static_cast<std::size_t>(st.st_size);
+            void *mapped = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+            if (mapped != MAP_FAILED)
+            {
+                _data = static_cast<const char *>(mapped);
+                _size = size;
+            }
+        }
+        ::close(fd);
+    }
+    ~MappedFile()
+    {
+        if (_data != nullptr)
+            ::munmap(const_cast<char *>(_data), _size);
+    }
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    const char *data() const { return _data; }
+    std::size_t size() const { return _size; }
+
+  private:
+    const char *_data{nullptr};
+    std::size_t _size{0};
+};
+} // namespace record_frame_detail
+
+// trailer of a framed record, written between the record text and its newline
+inline std::array<char, FRAME_TRAILER_SIZE> frameTrailer(const char *data, const std::size_t size)
+{
+    std::array<char, FRAME_TRAILER_SIZE> trailer{};
+    trailer[0] = record_frame_detail::TAG[0];
+    trailer[1] = record_frame_detail::TAG[1];
+    std::uint32_t crc = crc32c(data, size);
+    for (std::size_t i = FRAME_TRAILER_SIZE; i-- > sizeof(record_frame_detail::TAG);)
+    {
+        trailer[i] = record_frame_detail::HEX[crc & 0xf];
+        crc >>= 4;
+    }
+    return trailer;
+}
+
+// line without its newline is a record followed by a matching trailer
+inline bool isValidFrame(const char *line, const std::size_t size)
+{
+    if (!record_frame_detail::hasTrailer(line, size))
+        return false;
+    const std::size_t text = size - FRAME_TRAILER_SIZE;
+    std::uint32_t expected = 0;
+    for (std::size_t i = text + sizeof(record_frame_detail::TAG); i < size; ++i)
+    {
+        const auto digit = static_cast<std::uint32_t>(record_frame_detail::hexValue(line[i]));
+        expected = (expected << 4) | digit;
+    }
+    return crc32c(line, text) == expected;
+}
+
+struct FrameScan
+{
+    std::uint64_t records{};        // valid frames
+    std::uint64_t valid_end{};      // offset just past the last valid frame
+    std::vector<std::uint64_t> bad; // offsets of lines that fail their frame, mid-file too
+};
+
+// check every record of a framed log, e.g. after copying or archiving it
+inline FrameScan scanFrames(const std::string &path)
+{
+    FrameScan scan;
+    record_frame_detail::MappedFile file(path);
+    const char *data = file.data();
+    std::size_t start = 0;
+    while (start < file.size())
+    {
+        const void *newline = std::memchr(data + start, '\n', file.size() - start);
+        const std::size_t end =
+            newline == nullptr ? file.size() : static_cast<const char *>(newline) - data;
+        if (newline != nullptr && isValidFrame(data + start, end - start))
+        {
+            ++scan.records;
+            scan.valid_end = end + 1;
+        }
+        else
+            scan.bad.push_back(start);
+        start = end + 1;
+    }
+    return scan;
+}
+
+/*
+ * Crash recovery, run when a framed log is reopened: walks back from the end and truncates
+ * to just past the last valid frame. Dropped are the torn tail (no newline), lines whose
+ * trailer fails its checksum and lines with non-printable bytes (blocks the filesystem
+ * zero filled). It stops at the first valid frame, or at a clean line without a trailer so
+ * data written before framing was enabled is never touched. Returns the bytes dropped;
+ * index entries pointing into them are dropped as well.
+ */
+inline std::uint64_t recoverFramedLog(const std::string &path)
+{
+    std::size_t keep = 0;
+    std::size_t size = 0;
+    {
+        record_frame_detail::MappedFile file(path);
+        const char *data = file.data();
+        size = keep = file.size();
+        if (size == 0)
+            return 0;
+        // the part after the last newline was never completed
+        std::size_t end = size;
+        while (end > 0 && data[end - 1] != '\n')
+            --end;
+        keep = end;
+        while (end > 0)
+        {
+            std::size_t start = end - 1;
+            while (start > 0 && data[start - 1] != '\n')
+                --start;
+            const std::size_t length = end - 1 - start;
+            if (isValidFrame(data + start, length) ||
+                (!record_frame_detail::hasTrailer(data + start, length) &&
+                 record_frame_detail::isPrintable(data + start, length)))
+                break;
+            keep = end = start;
+        }
+    }
+    if (keep == size)
+        return 0;
+    if (::truncate(path.c_str(), static_cast<off_t>(keep)) != 0)
+        throw std::runtime_error("Cannot truncate torn log: " + path);
+
+    const std::string index_path = fileIndexPath(path);
+    auto entries = readFileIndex(index_path);
+    if (!entries.empty() && entries.back().offset >= keep)
+    {
+        FileIndexWriter index;
+        index.open(index_path, true);
+        for (const auto &entry : entries)
+        {
+            if (entry.offset < keep)
+                index.append(entry);
+        }
+    }
+    return size - keep;
+}
+
+} // namespace zerg
+
+#endif // RECORD_FRAME_HPP
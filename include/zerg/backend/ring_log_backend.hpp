@@ -0,0 +1,93 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RING_LOG_BACKEND_HPP
+#define RING_LOG_BACKEND_HPP
+
+#include <deque>            // std::deque
+#include <mutex>            // std::mutex, std::lock_guard
+#include <string>           // std::string
+#include "ilog_backend.hpp" // ILogBackend
+#include "../constants.hpp" // RING_BACKEND_CAPACITY
+
+namespace zerg
+{
+
+// The last capacity bytes of records in memory, oldest records evicted whole. Meant as the
+// secondary of a FailoverLogBackend when there is no second disk to fall back to;
+// snapshot() can be called from any thread, e.g. to dump it once the primary is back
+class RingLogBackend : public ILogBackend
+{
+  public:
+    explicit RingLogBackend(const std::size_t capacity = RING_BACKEND_CAPACITY)
+        : _capacity(capacity)
+    {
+    }
+
+    void write(const char *data, std::streamsize size) override
+    {
+        _record.append(data, static_cast<std::size_t>(size));
+    }
+    void writeNewline() override
+    {
+        _record.push_back('\n');
+        std::lock_guard<std::mutex> lock(_mutex);
+        _bytes += _record.size();
+        _records.push_back(std::move(_record));
+        _record.clear();
+        while (_bytes > _capacity && _records.size() > 1)
+        {
+            _bytes -= _records.front().size();
+            _records.pop_front();
+            ++_evicted;
+        }
+    }
+    void flush() override {}
+
+    // the records held, oldest first, newline terminated
+    [[nodiscard]] std::string snapshot() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        std::string out;
+        out.reserve(_bytes);
+        for (const auto &record : _records)
+            out += record;
+        return out;
+    }
+
+    // records pushed out by newer ones
+    [[nodiscard]] std::size_t evicted() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _evicted;
+    }
+
+  private:
+    const std::size_t _capacity;
+    std::string _record; // being written, backend thread only
+    mutable std::mutex _mutex;
+    std::deque<std::string> _records;
+    std::size_t _bytes{0};
+    std::size_t _evicted{0};
+};
+
+} // namespace zerg
+
+#endif // RING_LOG_BACKEND_HPP
@@ -0,0 +1,264 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TOKEN_BLOOM_HPP
+#define TOKEN_BLOOM_HPP
+
+#include <cmath>     // std::pow
+#include <cstdint>   // std::uint64_t, std::uint32_t
+#include <cstring>   // std::memcmp, std::strchr
+#include <fstream>   // std::ifstream, std::ofstream
+#include <stdexcept> // std::runtime_error
+#include <string>    // std::string
+#include <vector>    // std::vector
+
+namespace zerg
+{
+
+// Split a record into search tokens: runs of characters between whitespace and
+// []{}()<>,;"'= . Tokens containing ':' '/' or '.' ("a.cpp:10", "/api/v1") also yield their
+// parts, so a search for "a.cpp" or "10" can use the filter as well
+template <typename Fn> void forEachToken(const char *data, const std::size_t size, Fn &&fn)
+{
+    auto is_delimiter = [](const char c) {
+        return static_cast<unsigned char>(c) <= ' ' || std::strchr("[]{}()<>,;\"'=", c) != nullptr;
+    };
+    auto is_separator = [](const char c) { return c == ':' || c == '/' || c == '.'; };
+
+    std::size_t i = 0;
+    while (i < size)
+    {
+        while (i < size && is_delimiter(data[i]))
+            ++i;
+        const std::size_t start = i;
+        bool compound = false;
+        while (i < size && !is_delimiter(data[i]))
+            compound |= is_separator(data[i++]);
+        if (i == start)
+            break;
+        fn(data + start, i - start);
+        if (compound)
+        {
+            std::size_t part = start;
+            for (std::size_t j = start; j <= i; ++j)
+            {
+                if (j == i || is_separator(data[j]))
+                {
+                    if (j > part)
+                        fn(data + part, j - part);
+                    part = j + 1;
+                }
+            }
+        }
+    }
+}
+
+/*
+ * Bloom filter over the tokens of one log segment, saved next to it as "<log>.bloom"
+ * The bit count is a power of two, so a filter can be folded in half (OR of both halves)
+ * when the segment is closed: small segments get small sidecars while the false positive
+ * rate stays at the target. A folded filter is tiled back to full size to keep adding to it.
+ * File: "ZBLM", uint32 version, uint32 hashes, uint64 bits, uint64 tokens added, uint64 log
+ * bytes covered, bit words. A filter only speaks for a log of exactly the covered size, one
+ * left behind by a crash while the log kept growing must be ignored.
+ */
+class TokenBloomFilter
+{
+  public:
+    static constexpr std::uint32_t HASHES = 7;
+
+    explicit TokenBloomFilter(const std::uint64_t bits = 1ULL << 23)
+        : _words(static_cast<std::size_t>(roundBits(bits) / 64), 0)
+    {
+    }
+
+    void add(const char *token, const std::size_t size)
+    {
+        const std::uint64_t h = hash(token, size);
+        const std::uint64_t mask = bits() - 1;
+        for (std::uint32_t k = 0; k < HASHES; ++k)
+        {
+            const std::uint64_t bit = probe(h, k) & mask;
+            _words[static_cast<std::size_t>(bit >> 6)] |= 1ULL << (bit & 63);
+        }
+        ++_added;
+    }
+
+    void addTokens(const char *data, const std::size_t size)
+    {
+        forEachToken(data, size, [this](const char *t, const std::size_t n) { add(t, n); });
+    }
+
+    [[nodiscard]] bool mayContain(const char *token, const std::size_t size) const
+    {
+        const std::uint64_t h = hash(token, size);
+        const std::uint64_t mask = bits() - 1;
+        for (std::uint32_t k = 0; k < HASHES; ++k)
+        {
+            const std::uint64_t bit = probe(h, k) & mask;
+            if ((_words[static_cast<std::size_t>(bit >> 6)] & (1ULL << (bit & 63))) == 0)
+                return false;
+        }
+        return true;
+    }
+
+    // every token of text may be present (false = the segment cannot match)
+    [[nodiscard]] bool mayContainAll(const std::string &text) const
+    {
+        bool all = true;
+        forEachToken(text.data(), text.size(), [&](const char *t, const std::size_t n) {
+            all = all && mayContain(t, n);
+        });
+        return all;
+    }
+
+    [[nodiscard]] std::uint64_t bits() const
+    {
+        return static_cast<std::uint64_t>(_words.size()) * 64;
+    }
+    [[nodiscard]] std::uint64_t added() const { return _added; }
+    [[nodiscard]] std::uint64_t coveredBytes() const { return _covered; }
+    void setCoveredBytes(const std::uint64_t bytes) { _covered = bytes; }
+
+    [[nodiscard]] double falsePositiveRate() const
+    {
+        std::uint64_t set = 0;
+        for (const std::uint64_t word : _words)
+            set += static_cast<std::uint64_t>(__builtin_popcountll(word));
+        return std::pow(static_cast<double>(set) / static_cast<double>(bits()), HASHES);
+    }
+
+    // halve while the estimated false positive rate stays at or below target
+    void compact(const double target = 0.01)
+    {
+        while (_words.size() > 1)
+        {
+            TokenBloomFilter folded(*this);
+            folded.fold();
+            if (folded.falsePositiveRate() > target)
+                break;
+            *this = std::move(folded);
+        }
+    }
+
+    // tile a folded filter back up to bits, positions map onto the same folded bits
+    void expand(const std::uint64_t bits)
+    {
+        const std::size_t words = static_cast<std::size_t>(roundBits(bits) / 64);
+        const std::size_t have = _words.size();
+        if (words <= have)
+            return;
+        _words.resize(words);
+        for (std::size_t i = have; i < words; ++i)
+            _words[i] = _words[i % have];
+    }
+
+    void save(const std::string &path) const
+    {
+        std::ofstream out(path, std::ios::binary | std::ios::trunc);
+        const std::uint32_t header[2] = {VERSION, HASHES};
+        const std::uint64_t sizes[3] = {bits(), _added, _covered};
+        out.write(MAGIC, sizeof(MAGIC));
+        out.write(reinterpret_cast<const char *>(header), sizeof(header));
+        out.write(reinterpret_cast<const char *>(sizes), sizeof(sizes));
+        out.write(reinterpret_cast<const char *>(_words.data()),
+                  static_cast<std::streamsize>(_words.size() * sizeof(std::uint64_t)));
+        if (!out)
+            throw std::runtime_error("Could not write bloom filter " + path);
+    }
+
+    // throws std::runtime_error when path is missing or not a filter
+    static TokenBloomFilter load(const std::string &path)
+    {
+        std::ifstream in(path, std::ios::binary);
+        char magic[sizeof(MAGIC)];
+        std::uint32_t header[2];
+        std::uint64_t sizes[3];
+        if (!in.read(magic, sizeof(magic)) ||
+            !in.read(reinterpret_cast<char *>(header), sizeof(header)) ||
+            !in.read(reinterpret_cast<char *>(sizes), sizeof(sizes)) ||
+            std::memcmp(magic, MAGIC, sizeof(MAGIC)) != 0 || header[0] != VERSION ||
+            header[1] != HASHES || sizes[0] == 0 || roundBits(sizes[0]) != sizes[0])
+        {
+            throw std::runtime_error("Not a zerg bloom filter: " + path);
+        }
+        TokenBloomFilter filter(sizes[0]);
+        filter._added = sizes[1];
+        filter._covered = sizes[2];
+        if (!in.read(reinterpret_cast<char *>(filter._words.data()),
+                     static_cast<std::streamsize>(filter._words.size() * sizeof(std::uint64_t))))
+        {
+            throw std::runtime_error("Truncated bloom filter: " + path);
+        }
+        return filter;
+    }
+
+  private:
+    static constexpr char MAGIC[4] = {'Z', 'B', 'L', 'M'};
+    static constexpr std::uint32_t VERSION = 1;
+
+    static std::uint64_t roundBits(std::uint64_t bits)
+    {
+        std::uint64_t rounded = 64;
+        while (rounded < bits)
+            rounded <<= 1;
+        return rounded;
+    }
+
+    // FNV-1a, then a splitmix finaliser for well mixed high and low halves
+    static std::uint64_t hash(const char *data, const std::size_t size)
+    {
+        std::uint64_t h = 14695981039346656037ULL;
+        for (std::size_t i = 0; i < size; ++i)
+        {
+            h ^= static_cast<unsigned char>(data[i]);
+            h *= 1099511628211ULL;
+        }
+        h ^= h >> 30;
+        h *= 0xbf58476d1ce4e5b9ULL;
+        h ^= h >> 27;
+        h *= 0x94d049bb133111ebULL;
+        return h ^ (h >> 31);
+    }
+
+    // double hashing (Kirsch-Mitzenmacher)
+    static std::uint64_t probe(const std::uint64_t h, const std::uint32_t k)
+    {
+        return (h & 0xffffffffULL) + k * ((h >> 32) | 1);
+    }
+
+    void fold()
+    {
+        const std::size_t half = _words.size() / 2;
+        for (std::size_t i = 0; i < half; ++i)
+            _words[i] |= _words[i + half];
+        _words.resize(half);
+    }
+
+    std::vector<std::uint64_t> _words;
+    std::uint64_t _added{};
+    std::uint64_t _covered{};
+};
+
+inline std::string tokenBloomPath(const std::string &log_path) { return log_path + ".bloom"; }
+
+} // namespace zerg
+
+#endif // TOKEN_BLOOM_HPP
@@ -0,0 +1,232 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef BACKEND_POOL_HPP
+#define BACKEND_POOL_HPP
+
+#include "constants.hpp"   // CACHE_LINE_SIZE
+#include "fork_safety.hpp" // ForkAware, ForkRegistry
+
+#include <atomic>             // std::atomic
+#include <chrono>             // std::chrono::milliseconds
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // std::size_t
+#include <deque>              // std::deque
+#include <memory>             // std::unique_ptr
+#include <mutex>              // std::mutex, std::lock_guard
+#include <new>                // placement new
+#include <thread>             // std::thread
+#include <vector>             // std::vector
+
+namespace zerg
+{
+
+// A unit of backend work, implemented by Logger in pooled mode
+class PoolTask
+{
+  public:
+    virtual ~PoolTask() = default;
+    // drain a bounded amount of work, return true to stay scheduled
+    virtual bool runPoolTask() = 0;
+};
+
+/*
+ * Shared backend worker pool for processes with many loggers
+ * Each worker owns a deque of "logger has pending data" tasks. Producers schedule a logger
+ * only when it goes from idle to pending, so there is at most one task per logger and only
+ * one worker drains a logger at a time, which preserves per-logger order. Idle workers steal
+ * from the back of other deques, so a few busy loggers spread over all workers while quiet
+ * ones cost nothing but a queue.
+ * Workers are stopped before fork() and started again in parent and child (ForkRegistry),
+ * after the loggers running on them have been drained.
+ */
+class BackendPool : private ForkAware
+{
+  public:
+    explicit BackendPool(const std::size_t workers = defaultWorkers()) : _queues(workers)
+    {
+        for (std::size_t i = 0; i < workers; ++i)
+        {
+            _queues[i] = std::make_unique<WorkQueue>();
+        }
+        ForkRegistry::instance().add(this, ForkRegistry::POOL, [this] { startWorkers(); });
+    }
+
+    ~BackendPool() override
+    {
+        ForkRegistry::instance().remove(this);
+        stopWorkers();
+    }
+
+    BackendPool(const BackendPool &) = delete;
+    BackendPool &operator=(const BackendPool &) = delete;
+
+    // called by producers on the idle -> pending transition of a logger
+    void schedule(PoolTask *task)
+    {
+        const std::size_t target = _next.fetch_add(1, std::memory_order_relaxed) % _queues.size();
+        push(target, task);
+    }
+
+    [[nodiscard]] std::size_t workers() const { return _queues.size(); }
+    [[nodiscard]] std::size_t steals() const { return _steals.load(std::memory_order_relaxed); }
+
+    static std::size_t defaultWorkers()
+    {
+        const std::size_t cores = std::thread::hardware_concurrency();
+        return cores > 8 ? cores / 4 : 2;
+    }
+
+  private:
+    void startWorkers()
+    {
+        for (std::size_t i = 0; i < _queues.size(); ++i)
+        {
+            _workers.emplace_back(&BackendPool::workerLoop, this, i);
+        }
+    }
+
+    void stopWorkers()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_idle_mutex);
+            _stop = true;
+        }
+        _idle_cv.notify_all();
+        for (auto &worker : _workers)
+        {
+            if (worker.joinable())
+                worker.join();
+        }
+        _workers.clear();
+        _stop = false;
+    }
+
+    // the loggers are drained and detached by now, so the deques hold nothing of theirs
+    void prepareFork() override { stopWorkers(); }
+
+    void parentAfterFork() override { startWorkers(); }
+
+    void childAfterFork() override
+    {
+        // a producer of the parent may have held a deque lock at the time of the fork
+        for (auto &queue : _queues)
+        {
+            new (&queue->mutex) std::mutex;
+            queue->tasks.clear();
+        }
+        new (&_idle_mutex) std::mutex;
+        new (&_idle_cv) std::condition_variable;
+        _pending.store(0, std::memory_order_relaxed);
+        _idle.store(0, std::memory_order_relaxed);
+        startWorkers();
+    }
+
+    struct alignas(CACHE_LINE_SIZE) WorkQueue
+    {
+        std::mutex mutex;
+        std::deque<PoolTask *> tasks;
+    };
+
+    void push(const std::size_t target, PoolTask *task)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_queues[target]->mutex);
+            _queues[target]->tasks.push_back(task);
+        }
+        _pending.fetch_add(1, std::memory_order_seq_cst);
+        if (_idle.load(std::memory_order_seq_cst) > 0)
+        {
+            std::lock_guard<std::mutex> lock(_idle_mutex);
+            _idle_cv.notify_one();
+        }
+    }
+
+    PoolTask *popLocal(const std::size_t self)
+    {
+        auto &queue = *_queues[self];
+        std::lock_guard<std::mutex> lock(queue.mutex);
+        if (queue.tasks.empty())
+            return nullptr;
+        // FIFO for the owner keeps loggers sharing a worker fair
+        PoolTask *task = queue.tasks.front();
+        queue.tasks.pop_front();
+        return task;
+    }
+
+    PoolTask *steal(const std::size_t self)
+    {
+        for (std::size_t i = 1; i < _queues.size(); ++i)
+        {
+            auto &victim = *_queues[(self + i) % _queues.size()];
+            std::lock_guard<std::mutex> lock(victim.mutex);
+            if (!victim.tasks.empty())
+            {
+                PoolTask *task = victim.tasks.back();
+                victim.tasks.pop_back();
+                _steals.fetch_add(1, std::memory_order_relaxed);
+                return task;
+            }
+        }
+        return nullptr;
+    }
+
+    void workerLoop(const std::size_t self)
+    {
+        while (true)
+        {
+            PoolTask *task = popLocal(self);
+            if (task == nullptr)
+                task = steal(self);
+
+            if (task != nullptr)
+            {
+                _pending.fetch_sub(1, std::memory_order_relaxed);
+                if (task->runPoolTask())
+                    push(self, task); // still has data, go to the back of our own queue
+                continue;
+            }
+
+            std::unique_lock<std::mutex> lock(_idle_mutex);
+            if (_stop)
+                return;
+            _idle.fetch_add(1, std::memory_order_seq_cst);
+            // timeout is only a safety net, schedule() notifies idle workers
+            _idle_cv.wait_for(lock, std::chrono::milliseconds(50), [this] {
+                return _stop || _pending.load(std::memory_order_seq_cst) > 0;
+            });
+            _idle.fetch_sub(1, std::memory_order_seq_cst);
+        }
+    }
+
+    std::vector<std::unique_ptr<WorkQueue>> _queues;
+    std::vector<std::thread> _workers;
+    std::atomic<std::size_t> _next{0};
+    std::atomic<std::size_t> _pending{0};
+    std::atomic<std::size_t> _idle{0};
+    std::atomic<std::size_t> _steals{0};
+    std::mutex _idle_mutex;
+    std::condition_variable _idle_cv;
+    bool _stop{false};
+};
+
+} // namespace zerg
+
+#endif // BACKEND_POOL_HPP
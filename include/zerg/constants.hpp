@@ -28,6 +28,41 @@ constexpr size_t MAX_FILE_SIZE = 1024;
 
 constexpr size_t CACHE_LINE_SIZE = 64;
 
+// records per formatted chunk written under one _file_mutex acquisition
+constexpr size_t WRITE_CHUNK_RECORDS = 1024;
+// smallest chunk handed to a formatter thread, smaller batches are formatted inline
+constexpr size_t PARALLEL_FORMAT_MIN_CHUNK = 256;
+// records a pool worker drains from one logger before moving on to the next
+constexpr size_t POOL_DRAIN_BUDGET = 4096;
+// bytes of log between two entries of the FileLogBackend sidecar index
+constexpr size_t INDEX_INTERVAL_BYTES = 4 * 1024 * 1024;
+// FileLogBackend token bloom filter size while a segment is open (1 MiB), folded on close
+constexpr size_t BLOOM_FILTER_BITS = 8 * 1024 * 1024;
+// bytes of accepted but unwritten records the durable journal holds (Logger::enableJournal)
+constexpr size_t JOURNAL_CAPACITY = 64 * 1024 * 1024;
+// records written between two deadline checks while zerg::shutdown drains a logger
+constexpr size_t SHUTDOWN_DRAIN_BATCH = 256;
+// largest write FileLogOptions::shared_append issues for a batch (PIPE_BUF)
+constexpr size_t APPEND_ATOMIC_SIZE = 4096;
+// bytes of WARN+ records a degraded logger keeps while its backend fails, newer ones are shed
+constexpr size_t DEGRADED_BUFFER_SIZE = 4 * 1024 * 1024;
+// first and longest wait between two recovery probes of a failed backend, doubling
+constexpr size_t DEGRADED_PROBE_MIN_MS = 100;
+constexpr size_t DEGRADED_PROBE_MAX_MS = 30 * 1000;
+// RetentionManager shrinks a large segment in steps of this many bytes before the unlink
+constexpr size_t RETENTION_TRUNCATE_STEP = 64 * 1024 * 1024;
+// FailoverLogBackend: longest wait for the primary sink, time between recovery probes and
+// bytes of records handed to its I/O thread at once
+constexpr size_t FAILOVER_DEADLINE_MS = 250;
+constexpr size_t FAILOVER_RETRY_MS = 2000;
+constexpr size_t FAILOVER_BATCH_SIZE = 64 * 1024;
+// RingLogBackend default capacity
+constexpr size_t RING_BACKEND_CAPACITY = 4 * 1024 * 1024;
+// byte quota estimate of a record before formatting: timestamp, level and location, and a
+// non-string argument
+constexpr size_t QUOTA_RECORD_OVERHEAD = 48;
+constexpr size_t QUOTA_ARG_ESTIMATE = 8;
+
 constexpr size_t SHIFT_1 = 1;
 constexpr size_t SHIFT_2 = 2;
 constexpr size_t SHIFT_4 = 4;
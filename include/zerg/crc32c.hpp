@@ -0,0 +1,111 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef CRC32C_HPP
+#define CRC32C_HPP
+
+#include <array>   // std::array
+#include <cstddef> // std::size_t
+#include <cstdint> // std::uint32_t, std::uint64_t
+#include <cstring> // std::memcpy
+
+#if defined(__x86_64__) && (defined(__GNUC__) || defined(__clang__))
+#include <nmmintrin.h> // _mm_crc32_u64, _mm_crc32_u8
+#define ZERG_HAS_HW_CRC32C 1
+#endif
+
+namespace zerg
+{
+
+/*
+ * CRC32C (Castagnoli), as used by iSCSI, ext4 and most log formats
+ * Computed with the SSE4.2 crc32 instruction, 8 bytes per instruction, when the CPU has it
+ * (checked once at runtime, so the library itself is still built for baseline x86-64), and
+ * with a byte-wise table otherwise.
+ */
+namespace crc32c_detail
+{
+constexpr std::uint32_t POLYNOMIAL = 0x82F63B78; // reflected Castagnoli
+
+inline const std::array<std::uint32_t, 256> &table()
+{
+    static const std::array<std::uint32_t, 256> entries = [] {
+        std::array<std::uint32_t, 256> t{};
+        for (std::uint32_t i = 0; i < 256; ++i)
+        {
+            std::uint32_t crc = i;
+            for (int bit = 0; bit < 8; ++bit)
+                crc = (crc >> 1) ^ ((crc & 1) ? POLYNOMIAL : 0);
+            t[i] = crc;
+        }
+        return t;
+    }();
+    return entries;
+}
+
+inline std::uint32_t software(std::uint32_t crc, const unsigned char *data, std::size_t size)
+{
+    const auto &t = table();
+    while (size-- > 0)
+        crc = t[(crc ^ *data++) & 0xff] ^ (crc >> 8);
+    return crc;
+}
+
+#ifdef ZERG_HAS_HW_CRC32C
+__attribute__((target("sse4.2"))) inline std::uint32_t hardware(std::uint32_t crc,
+                                                                const unsigned char *data,
+                                                                std::size_t size)
+{
+    std::uint64_t crc64 = crc;
+    for (; size >= sizeof(std::uint64_t); size -= sizeof(std::uint64_t))
+    {
+        std::uint64_t word;
+        std::memcpy(&word, data, sizeof(word));
+        crc64 = _mm_crc32_u64(crc64, word);
+        data += sizeof(word);
+    }
+    crc = static_cast<std::uint32_t>(crc64);
+    while (size-- > 0)
+        crc = _mm_crc32_u8(crc, *data++);
+    return crc;
+}
+
+inline bool hasHardware()
+{
+    static const bool supported = __builtin_cpu_supports("sse4.2");
+    return supported;
+}
+#endif
+} // namespace crc32c_detail
+
+// crc of data, chain calls by passing the previous result as crc
+inline std::uint32_t crc32c(const void *data, const std::size_t size, const std::uint32_t crc = 0)
+{
+    const auto *bytes = static_cast<const unsigned char *>(data);
+#ifdef ZERG_HAS_HW_CRC32C
+    if (crc32c_detail::hasHardware())
+        return ~crc32c_detail::hardware(~crc, bytes, size);
+#endif
+    return ~crc32c_detail::software(~crc, bytes, size);
+}
+
+} // namespace zerg
+
+#endif // CRC32C_HPP
@@ -0,0 +1,320 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef DURABLE_JOURNAL_HPP
+#define DURABLE_JOURNAL_HPP
+
+#include <atomic>         // std::atomic
+#include <cstdint>        // std::uint32_t, std::uint64_t, std::int64_t
+#include <cstring>        // std::memcpy, std::memcmp
+#include <fcntl.h>        // open
+#include <mutex>          // std::mutex, std::lock_guard
+#include <new>            // placement new
+#include <stdexcept>      // std::runtime_error
+#include <string>         // std::string
+#include <sys/mman.h>     // mmap, munmap
+#include <sys/stat.h>     // fstat
+#include <unistd.h>       // ftruncate, close
+#include <vector>         // std::vector
+#include "constants.hpp"  // JOURNAL_CAPACITY, CACHE_LINE_SIZE
+#include "verbosity.hpp"  // Verbosity
+
+namespace zerg
+{
+
+// a record accepted by Logger::log but not yet confirmed written, see DurableJournal::pending
+struct JournalRecord
+{
+    std::uint64_t position;
+    Verbosity level;
+    int line;
+    std::int64_t time_ns;
+    std::string file;
+    std::string message;
+};
+
+/*
+ * Crash surviving record journal, a variable length byte ring in a MAP_SHARED file mapping
+ * Producers reserve space with a CAS on the head, copy the record in and publish it by
+ * setting its state to COMMITTED. The backend marks records DONE once they are flushed to
+ * the log file and reclaim() advances the tail over the DONE prefix. Nothing is synced: the
+ * mapping lives in the page cache, so it survives the process being killed (not a power
+ * loss) and costs producers a memcpy, no syscall.
+ * After a crash pending() returns every COMMITTED record between tail and head, for the
+ * restarted logger (or a recovery tool) to write out. Every record carries its position,
+ * so headers left over from an earlier lap or a reservation cut short by the crash are
+ * recognised and skipped.
+ */
+class DurableJournal
+{
+  public:
+    static constexpr std::uint64_t FULL = UINT64_MAX;
+
+    // opens or creates path; an existing journal keeps its capacity and its records.
+    // Throws std::runtime_error if the file cannot be mapped or is not a journal
+    explicit DurableJournal(const std::string &path, std::size_t capacity = JOURNAL_CAPACITY)
+    {
+        capacity = static_cast<std::size_t>(align(capacity));
+        const int fd = ::open(path.c_str(), O_RDWR | O_CREAT | O_CLOEXEC, 0644);
+        if (fd < 0)
+            throw std::runtime_error("Cannot open journal: " + path);
+        struct stat st{};
+        ::fstat(fd, &st);
+        const bool fresh = st.st_size == 0;
+        if (fresh && ::ftruncate(fd, static_cast<off_t>(sizeof(Header) + capacity)) != 0)
+        {
+            ::close(fd);
+            throw std::runtime_error("Cannot size journal: " + path);
+        }
+        if (!fresh)
+        {
+            Header existing;
+            if (static_cast<std::size_t>(st.st_size) < sizeof(Header) ||
+                ::pread(fd, &existing, sizeof(existing), 0) != sizeof(existing) ||
+                std::memcmp(existing.magic, MAGIC, sizeof(MAGIC)) != 0 ||
+                existing.version != VERSION ||
+                sizeof(Header) + existing.capacity != static_cast<std::uint64_t>(st.st_size))
+            {
+                ::close(fd);
+                throw std::runtime_error("Not a zerg journal: " + path);
+            }
+            capacity = static_cast<std::size_t>(existing.capacity);
+        }
+
+        _mapping_size = sizeof(Header) + capacity;
+        void *mapped = ::mmap(nullptr, _mapping_size, PROT_READ | PROT_WRITE, MAP_SHARED, fd, 0);
+        ::close(fd);
+        if (mapped == MAP_FAILED)
+            throw std::runtime_error("Cannot map journal: " + path);
+        _header = static_cast<Header *>(mapped);
+        _data = static_cast<char *>(mapped) + sizeof(Header);
+        _capacity = capacity;
+        if (fresh)
+        {
+            new (_header) Header{};
+            std::memcpy(_header->magic, MAGIC, sizeof(MAGIC));
+            _header->version = VERSION;
+            _header->capacity = capacity;
+        }
+    }
+
+    ~DurableJournal() { ::munmap(_header, _mapping_size); }
+
+    DurableJournal(const DurableJournal &) = delete;
+    DurableJournal &operator=(const DurableJournal &) = delete;
+
+    // position of the committed record, FULL if the unwritten records already fill the ring
+    std::uint64_t append(const Verbosity level, const char *file, const int line,
+                         const std::int64_t time_ns, const std::string &message)
+    {
+        const auto file_size = static_cast<std::uint32_t>(std::strlen(file));
+        const auto message_size = static_cast<std::uint32_t>(message.size());
+        const std::uint64_t size =
+            align(sizeof(RecordHeader) + sizeof(Payload) + file_size + message_size);
+
+        std::uint64_t head = _header->head.load(std::memory_order_relaxed);
+        std::uint64_t pad;
+        do
+        {
+            // records never wrap, the rest of the lap becomes padding
+            const std::uint64_t offset = head % _capacity;
+            pad = offset + size > _capacity ? _capacity - offset : 0;
+            if (head + pad + size - _header->tail.load(std::memory_order_acquire) > _capacity)
+                return FULL;
+        } while (!_header->head.compare_exchange_weak(head, head + pad + size,
+                                                      std::memory_order_acq_rel,
+                                                      std::memory_order_relaxed));
+
+        if (pad != 0)
+            publish(head, pad, PADDING);
+        const std::uint64_t position = head + pad;
+        RecordHeader *record = begin(position, size);
+        const Payload payload{time_ns, static_cast<std::uint32_t>(level), line, file_size,
+                              message_size};
+        char *out = reinterpret_cast<char *>(record + 1);
+        std::memcpy(out, &payload, sizeof(payload));
+        std::memcpy(out + sizeof(payload), file, file_size);
+        std::memcpy(out + sizeof(payload) + file_size, message.data(), message_size);
+        record->state.store(COMMITTED, std::memory_order_release);
+        return position;
+    }
+
+    // the record is in the log (flushed to the kernel), its space can be reused
+    void markDone(const std::uint64_t position)
+    {
+        recordAt(position)->state.store(DONE, std::memory_order_release);
+    }
+
+    // advance the tail over records marked done, in order
+    void reclaim()
+    {
+        std::lock_guard<std::mutex> lock(_reclaim_mutex);
+        std::uint64_t tail = _header->tail.load(std::memory_order_relaxed);
+        const std::uint64_t head = _header->head.load(std::memory_order_acquire);
+        while (tail < head)
+        {
+            RecordHeader *record = recordAt(tail);
+            // a producer still writing its header, or a stale header from the last lap
+            if (record->position.load(std::memory_order_acquire) != tail)
+                break;
+            const std::uint32_t state = record->state.load(std::memory_order_acquire);
+            if (state != DONE && state != PADDING)
+                break;
+            tail += record->length.load(std::memory_order_relaxed);
+        }
+        _header->tail.store(tail, std::memory_order_release);
+    }
+
+    // committed records not yet marked done, oldest first. Only meaningful while no producer
+    // is appending, i.e. when a journal is reopened after a crash
+    [[nodiscard]] std::vector<JournalRecord> pending() const
+    {
+        std::vector<JournalRecord> records;
+        const std::uint64_t head = _header->head.load(std::memory_order_acquire);
+        std::uint64_t position = _header->tail.load(std::memory_order_acquire);
+        while (position < head)
+        {
+            const RecordHeader *record = recordAt(position);
+            const std::uint64_t offset = position % _capacity;
+            const std::uint32_t length = record->length.load(std::memory_order_relaxed);
+            if (record->position.load(std::memory_order_acquire) != position ||
+                length < sizeof(RecordHeader) || length % ALIGN != 0 ||
+                offset + length > _capacity)
+            {
+                // reservation never written: step over it until the next valid header
+                position += ALIGN;
+                continue;
+            }
+            if (record->state.load(std::memory_order_acquire) == COMMITTED &&
+                length >= sizeof(RecordHeader) + sizeof(Payload))
+            {
+                const char *in = reinterpret_cast<const char *>(record + 1);
+                Payload payload;
+                std::memcpy(&payload, in, sizeof(payload));
+                if (sizeof(RecordHeader) + sizeof(Payload) + payload.file_size +
+                        payload.message_size <=
+                    length)
+                {
+                    in += sizeof(payload);
+                    records.push_back({position, static_cast<Verbosity>(payload.level),
+                                       payload.line, payload.time_ns,
+                                       std::string(in, payload.file_size),
+                                       std::string(in + payload.file_size, payload.message_size)});
+                }
+            }
+            position += length;
+        }
+        return records;
+    }
+
+    // forget every record, once pending() has been written out. No producer may be appending
+    void clear()
+    {
+        std::lock_guard<std::mutex> lock(_reclaim_mutex);
+        _header->tail.store(_header->head.load(std::memory_order_acquire),
+                            std::memory_order_release);
+    }
+
+    [[nodiscard]] std::size_t capacity() const { return _capacity; }
+
+    // bytes between tail and head: records not yet reclaimed
+    [[nodiscard]] std::uint64_t used() const
+    {
+        return _header->head.load(std::memory_order_acquire) -
+               _header->tail.load(std::memory_order_acquire);
+    }
+
+  private:
+    static constexpr char MAGIC[4] = {'Z', 'J', 'N', 'L'};
+    static constexpr std::uint32_t VERSION = 1;
+    static constexpr std::uint64_t ALIGN = 16;
+
+    enum State : std::uint32_t
+    {
+        RESERVED = 0,
+        COMMITTED = 1,
+        DONE = 2,
+        PADDING = 3,
+    };
+
+    struct alignas(CACHE_LINE_SIZE) Header
+    {
+        char magic[4];
+        std::uint32_t version;
+        std::uint64_t capacity;
+        alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> head{0};
+        alignas(CACHE_LINE_SIZE) std::atomic<std::uint64_t> tail{0};
+    };
+
+    struct RecordHeader
+    {
+        std::atomic<std::uint32_t> state;
+        std::atomic<std::uint32_t> length; // whole record, header and padding included
+        std::atomic<std::uint64_t> position;
+    };
+    static_assert(sizeof(RecordHeader) == ALIGN, "record headers must keep records aligned");
+    static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+                  "journal atomics must be lock free to live in a shared mapping");
+
+    struct Payload
+    {
+        std::int64_t time_ns;
+        std::uint32_t level;
+        std::int32_t line;
+        std::uint32_t file_size;
+        std::uint32_t message_size;
+    };
+
+    static std::uint64_t align(const std::uint64_t size)
+    {
+        return (size + ALIGN - 1) / ALIGN * ALIGN;
+    }
+
+    RecordHeader *recordAt(const std::uint64_t position) const
+    {
+        return reinterpret_cast<RecordHeader *>(_data + position % _capacity);
+    }
+
+    // claim the header for this lap: state first, so a reader that sees the new position
+    // never sees the state a record here had on the previous lap
+    RecordHeader *begin(const std::uint64_t position, const std::uint64_t length)
+    {
+        RecordHeader *record = recordAt(position);
+        record->state.store(RESERVED, std::memory_order_relaxed);
+        record->length.store(static_cast<std::uint32_t>(length), std::memory_order_relaxed);
+        record->position.store(position, std::memory_order_release);
+        return record;
+    }
+
+    void publish(const std::uint64_t position, const std::uint64_t length, const State state)
+    {
+        begin(position, length)->state.store(state, std::memory_order_release);
+    }
+
+    Header *_header{nullptr};
+    char *_data{nullptr};
+    std::size_t _capacity{0};
+    std::size_t _mapping_size{0};
+    std::mutex _reclaim_mutex;
+};
+
+} // namespace zerg
+
+#endif // DURABLE_JOURNAL_HPP
@@ -0,0 +1,125 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FORK_SAFETY_HPP
+#define FORK_SAFETY_HPP
+
+#include <algorithm>  // std::stable_sort, std::remove_if
+#include <mutex>      // std::mutex, std::lock_guard
+#include <pthread.h>  // pthread_atfork
+#include <utility>    // std::pair
+#include <vector>     // std::vector
+
+namespace zerg
+{
+
+// Something owning threads or locks that has to be quiesced around fork()
+class ForkAware
+{
+  public:
+    virtual ~ForkAware() = default;
+    // parent, before fork: finish in-flight work, stop threads, take the locks
+    virtual void prepareFork() = 0;
+    // parent, after fork: release the locks, restart threads
+    virtual void parentAfterFork() = 0;
+    // child, after fork: the same, with whatever the parent's other threads left behind reset
+    virtual void childAfterFork() = 0;
+};
+
+/*
+ * Process wide list of ForkAware objects, driven by one pthread_atfork registration
+ * Loggers are prepared before the backend pools they may run on and restarted after them.
+ * The registry lock is held from prepare to after-fork, so no logger is created or
+ * destroyed across the fork.
+ */
+class ForkRegistry
+{
+  public:
+    enum Stage : int
+    {
+        LOGGER = 0, // drained first, restarted last
+        POOL = 1,
+    };
+
+    static ForkRegistry &instance()
+    {
+        // never destroyed: the statics holding the global loggers are constructed before
+        // the first logger registers, so they are destroyed after the registry would be
+        static ForkRegistry *registry = new ForkRegistry;
+        return *registry;
+    }
+
+    // start (the handler's threads) runs under the registry lock, so a concurrent fork sees
+    // either no handler and no threads or both
+    template <typename Start> void add(ForkAware *handler, const Stage stage, Start &&start)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        start();
+        _handlers.emplace_back(stage, handler);
+        std::stable_sort(_handlers.begin(), _handlers.end(),
+                         [](const auto &a, const auto &b) { return a.first < b.first; });
+    }
+
+    void remove(ForkAware *handler)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _handlers.erase(std::remove_if(_handlers.begin(), _handlers.end(),
+                                       [handler](const auto &h) { return h.second == handler; }),
+                        _handlers.end());
+    }
+
+  private:
+    ForkRegistry()
+    {
+        pthread_atfork(&ForkRegistry::prepare, &ForkRegistry::parent, &ForkRegistry::child);
+    }
+
+    static void prepare()
+    {
+        ForkRegistry &registry = instance();
+        registry._mutex.lock();
+        for (auto &handler : registry._handlers)
+            handler.second->prepareFork();
+    }
+
+    static void parent()
+    {
+        ForkRegistry &registry = instance();
+        for (auto it = registry._handlers.rbegin(); it != registry._handlers.rend(); ++it)
+            it->second->parentAfterFork();
+        registry._mutex.unlock();
+    }
+
+    static void child()
+    {
+        // the forking thread is the only one left and it still owns the lock
+        ForkRegistry &registry = instance();
+        for (auto it = registry._handlers.rbegin(); it != registry._handlers.rend(); ++it)
+            it->second->childAfterFork();
+        registry._mutex.unlock();
+    }
+
+    std::mutex _mutex;
+    std::vector<std::pair<Stage, ForkAware *>> _handlers;
+};
+
+} // namespace zerg
+
+#endif // FORK_SAFETY_HPP
@@ -0,0 +1,132 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef FORMAT_POOL_HPP
+#define FORMAT_POOL_HPP
+
+#include <condition_variable> // std::condition_variable
+#include <cstddef>            // std::size_t
+#include <deque>              // std::deque
+#include <functional>         // std::function
+#include <mutex>              // std::mutex, std::unique_lock
+#include <thread>             // std::thread
+#include <vector>             // std::vector
+
+namespace zerg
+{
+
+/*
+ * Formatter thread pool for the pipelined backend (@Logger::setFormatterThreads)
+ * pipeline() hands disjoint chunks of a drained batch to the workers and lets the calling
+ * (writer) thread emit every chunk in sequence order as soon as it and all chunks before it
+ * are formatted, so output order matches queue order while formatting scales with cores.
+ * Dispatch is per chunk, not per record, so the mutex here is off the hot path.
+ */
+class FormatPool
+{
+  public:
+    explicit FormatPool(const std::size_t threads)
+    {
+        for (std::size_t i = 0; i < threads; ++i)
+        {
+            _workers.emplace_back(&FormatPool::workerLoop, this);
+        }
+    }
+
+    ~FormatPool()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cv.notify_all();
+        for (auto &worker : _workers)
+        {
+            if (worker.joinable())
+                worker.join();
+        }
+    }
+
+    FormatPool(const FormatPool &) = delete;
+    FormatPool &operator=(const FormatPool &) = delete;
+
+    [[nodiscard]] std::size_t threads() const { return _workers.size(); }
+
+    // format(i) runs on the pool for every chunk, write(i) runs on the caller in order 0..n-1
+    void pipeline(const std::size_t chunks, const std::function<void(std::size_t)> &format,
+                  const std::function<void(std::size_t)> &write)
+    {
+        std::mutex done_mutex;
+        std::condition_variable done_cv;
+        std::vector<bool> done(chunks, false);
+
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (std::size_t i = 0; i < chunks; ++i)
+            {
+                _tasks.emplace_back([&, i] {
+                    format(i);
+                    // notify under the lock: once the writer sees the last chunk done it
+                    // returns and destroys done_cv
+                    std::lock_guard<std::mutex> done_lock(done_mutex);
+                    done[i] = true;
+                    done_cv.notify_one();
+                });
+            }
+        }
+        _cv.notify_all();
+
+        for (std::size_t i = 0; i < chunks; ++i)
+        {
+            {
+                std::unique_lock<std::mutex> done_lock(done_mutex);
+                done_cv.wait(done_lock, [&] { return done[i]; });
+            }
+            write(i);
+        }
+    }
+
+  private:
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        while (true)
+        {
+            _cv.wait(lock, [this] { return _stop || !_tasks.empty(); });
+            if (_stop && _tasks.empty())
+                return;
+            auto task = std::move(_tasks.front());
+            _tasks.pop_front();
+            lock.unlock();
+            task();
+            lock.lock();
+        }
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::deque<std::function<void()>> _tasks;
+    std::vector<std::thread> _workers;
+    bool _stop{false};
+};
+
+} // namespace zerg
+
+#endif // FORMAT_POOL_HPP
@@ -24,21 +24,91 @@ inline std::string &getLogFilePath()
 
 inline void setLogFilePath(const std::string &path) { getLogFilePath() = path; }
 
-inline std::shared_ptr<Logger<DEFAULT_BUFFER_SIZE>> &
-getFileLogger(const std::string &filename = "")
+// process wide workload capture, see enableTraceCapture
+inline std::unique_ptr<TraceRecorder> &getTraceRecorder()
+{
+    static std::unique_ptr<TraceRecorder> recorder;
+    return recorder;
+}
+
+// shared backend workers for the file loggers, see enableBackendPool
+inline std::unique_ptr<BackendPool> &getBackendPool()
 {
+    static std::unique_ptr<BackendPool> pool;
+    return pool;
+}
+
+inline std::unordered_map<std::string, std::shared_ptr<Logger<DEFAULT_BUFFER_SIZE>>> &
+fileLoggerInstances()
+{
+    // touch the recorder and pool first so they are destroyed after the loggers
+    getTraceRecorder();
+    getBackendPool();
     static std::unordered_map<std::string, std::shared_ptr<Logger<DEFAULT_BUFFER_SIZE>>> instances;
+    return instances;
+}
+
+inline std::mutex &fileLoggerMutex()
+{
     static std::mutex mtx;
+    return mtx;
+}
 
-    std::lock_guard<std::mutex> lock(mtx);
+inline std::shared_ptr<Logger<DEFAULT_BUFFER_SIZE>> &
+getFileLogger(const std::string &filename = "")
+{
+    auto &instances = fileLoggerInstances();
+
+    std::lock_guard<std::mutex> lock(fileLoggerMutex());
     std::string fullPath = getLogFilePath() + (filename.empty() ? getLogFileName() : filename);
     if (instances.find(fullPath) == instances.end())
     {
-        instances[fullPath] = std::make_shared<Logger<DEFAULT_BUFFER_SIZE>>(fullPath);
+        instances[fullPath] = std::make_shared<Logger<DEFAULT_BUFFER_SIZE>>(
+            fullPath, Verbosity::DEBUG_LVL, nullptr, getBackendPool().get());
+        instances[fullPath]->setTraceRecorder(getTraceRecorder().get());
     }
     return instances[fullPath];
 }
 
+// Capture a replayable trace of every call made through the file loggers (existing and
+// created later) into path. Enable once, before the workload starts.
+inline void enableTraceCapture(const std::string &path)
+{
+    auto &instances = fileLoggerInstances();
+
+    std::lock_guard<std::mutex> lock(fileLoggerMutex());
+    if (getTraceRecorder())
+    {
+        throw std::runtime_error("Trace capture is already enabled");
+    }
+    getTraceRecorder() = std::make_unique<TraceRecorder>(path);
+    for (auto &[path_key, logger] : instances)
+    {
+        logger->setTraceRecorder(getTraceRecorder().get());
+    }
+}
+
+// Drain file loggers created from now on with a shared pool of workers instead of one
+// backend thread each. Meant for processes with many loggers of uneven activity
+inline void enableBackendPool(const std::size_t workers = BackendPool::defaultWorkers())
+{
+    fileLoggerInstances();
+
+    std::lock_guard<std::mutex> lock(fileLoggerMutex());
+    if (getBackendPool())
+    {
+        throw std::runtime_error("Backend pool is already enabled");
+    }
+    getBackendPool() = std::make_unique<BackendPool>(workers);
+}
+
+// per tenant limits for the logger cpp_log_with_file(level, filename, ...) writes to,
+// see Logger::setQuota. Violations are read with getFileLogger(filename)->quotaViolations()
+inline void setFileLoggerQuota(const std::string &filename, const LogQuota &quota)
+{
+    getFileLogger(filename)->setQuota(quota);
+}
+
 inline void setGlobalLoggerVerbosity(const Verbosity level)
 {
     getFileLogger()->setLogLevel(level);
@@ -82,6 +152,14 @@ inline void loadConfiguration(const std::string &configFile)
             {
                 setLogFilePath(value);
             }
+            else if (key == "traceFile")
+            {
+                enableTraceCapture(value);
+            }
+            else if (key == "backendWorkers")
+            {
+                enableBackendPool(std::stoul(value));
+            }
         }
     }
 }
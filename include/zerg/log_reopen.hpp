@@ -0,0 +1,68 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef LOG_REOPEN_HPP
+#define LOG_REOPEN_HPP
+
+#include <atomic>   // std::atomic
+#include <csignal>  // sigaction, SIGHUP
+#include <cstdint>  // std::uint64_t
+
+namespace zerg
+{
+
+namespace reopen_detail
+{
+// bumped once per request; every logger compares it with the generation it last reopened at
+// before writing its next chunk, so one request reaches all of them
+inline std::atomic<std::uint64_t> generation{0};
+static_assert(std::atomic<std::uint64_t>::is_always_lock_free,
+              "requestReopen has to be async-signal-safe");
+
+inline void onSignal(int) { generation.fetch_add(1, std::memory_order_relaxed); }
+} // namespace reopen_detail
+
+// Ask every logger to close and reopen its file before its next write, e.g. after logrotate
+// renamed it. A single lock-free increment, safe to call from a signal handler. Records
+// already queued are not lost: those written before the reopen end up in the old file
+inline void requestReopen() noexcept
+{
+    reopen_detail::generation.fetch_add(1, std::memory_order_relaxed);
+}
+
+inline std::uint64_t reopenGeneration() noexcept
+{
+    return reopen_detail::generation.load(std::memory_order_relaxed);
+}
+
+// route signal (logrotate's postrotate usually sends SIGHUP) to requestReopen.
+// Replaces any handler installed for it, returns false if sigaction fails
+inline bool installReopenHandler(const int signal = SIGHUP)
+{
+    struct sigaction action{};
+    action.sa_handler = reopen_detail::onSignal;
+    sigemptyset(&action.sa_mask);
+    action.sa_flags = SA_RESTART;
+    return sigaction(signal, &action, nullptr) == 0;
+}
+
+} // namespace zerg
+
+#endif // LOG_REOPEN_HPP
@@ -35,13 +35,14 @@ namespace zerg
 template <typename LogEntry>
 void syncLogs(LockFreeQueue<LogEntry> &log_buffer, std::unique_ptr<ILogBackend> &backend,
               std::mutex &file_mutex, std::condition_variable &empty_cv, std::mutex &empty_mutex,
-              std::function<void(const LogEntry &)> processLogEntry)
+              std::function<void(LogEntry &, std::size_t ticket)> processLogEntry)
 {
 #ifdef BENCHMARK_MODE
     LogEntry entry;
-    while (log_buffer.dequeue(entry))
+    std::size_t ticket;
+    while (log_buffer.dequeue(entry, ticket))
     {
-        processLogEntry(entry);
+        processLogEntry(entry, ticket);
     }
     {
         std::lock_guard<std::mutex> lock(file_mutex);
@@ -49,15 +50,16 @@ void syncLogs(LockFreeQueue<LogEntry> &log_buffer, std::unique_ptr<ILogBackend>
     }
 #else
     LogEntry entry;
+    std::size_t ticket;
     const auto stable_duration = std::chrono::milliseconds(50);
     auto start_stable = std::chrono::steady_clock::now();
 
     while (true)
     {
         bool processed = false;
-        while (log_buffer.dequeue(entry))
+        while (log_buffer.dequeue(entry, ticket))
         {
-            processLogEntry(entry);
+            processLogEntry(entry, ticket);
             processed = true;
         }
         {
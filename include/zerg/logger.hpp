@@ -26,7 +26,18 @@
 #include "backend/file_log_backend.hpp" // FileLogBackend
 #include "verbosity.hpp"                // Verbosity
 #include "log_sync.hpp"                 // syncLogs, waitUntilEmpty
+#include "trace_capture.hpp"            // TraceRecorder
+#include "format_pool.hpp"              // FormatPool
+#include "backend_pool.hpp"             // BackendPool, PoolTask
+#include "tsc_clock.hpp"                // TscClock
+#include "durable_journal.hpp"          // DurableJournal
+#include "fork_safety.hpp"              // ForkAware, ForkRegistry
+#include "shutdown.hpp"                 // Drainable, DrainRegistry
+#include "log_reopen.hpp"               // reopenGeneration
+#include "retention.hpp"                // RetentionPolicy, RetentionManager
+#include "rate_quota.hpp"               // LogQuota, RateQuota
 
+#include <algorithm>          // std::min, std::remove_if
 #include <iostream>           // std::cout, std::cerr
 #include <fstream>            // std::ofstream
 #include <string>             // std::string
@@ -38,13 +49,84 @@
 #include <thread>             // std::thread
 #include <condition_variable> // std::condition_variable
 #include <atomic>             // std::atomic, std::memory_order_*
+#include <chrono>             // std::chrono::steady_clock, std::chrono::milliseconds
 #include <vector>             // std::vector
+#include <utility>            // std::pair
+#include <iterator>           // std::make_move_iterator
 #include <array>              // std::array
+#include <mutex>              // std::mutex, std::lock_guard
+#include <unordered_set>      // std::unordered_set
+#include <cstdint>            // std::uint64_t, SIZE_MAX
+#include <cstdio>             // std::snprintf
+#include <cstring>            // std::strerror
+#include <stdexcept>          // std::runtime_error
+#include <pthread.h>          // pthread_setaffinity_np
+#include <sched.h>            // cpu_set_t, CPU_SET
+#include <unistd.h>           // getpid
+#include <new>                // placement new
 #include "macros.hpp"         // PREFETCH, likely, unlikely
 
 namespace zerg
 {
 
+// small process wide index of the calling thread, starting at 1
+inline std::uint32_t currentThreadIndex()
+{
+    static std::atomic<std::uint32_t> next{1};
+    thread_local const std::uint32_t index = next.fetch_add(1, std::memory_order_relaxed);
+    return index;
+}
+
+// Process wide id of a logger, never reused like its address. Ids of destroyed loggers are
+// forgotten, so what threads keep per logger (the per-thread sequence counters) can be pruned
+class LoggerId
+{
+  public:
+    LoggerId() : _id(next().fetch_add(1, std::memory_order_relaxed))
+    {
+        std::lock_guard<std::mutex> lock(live().mutex);
+        live().ids.insert(_id);
+    }
+    ~LoggerId()
+    {
+        std::lock_guard<std::mutex> lock(live().mutex);
+        live().ids.erase(_id);
+    }
+    LoggerId(const LoggerId &) = delete;
+    LoggerId &operator=(const LoggerId &) = delete;
+
+    std::uint64_t value() const { return _id; }
+
+    // drop the entries of entries (pairs keyed by id) whose logger is gone
+    template <typename Entries> static void eraseDead(Entries &entries)
+    {
+        std::lock_guard<std::mutex> lock(live().mutex);
+        entries.erase(std::remove_if(entries.begin(), entries.end(),
+                                     [](const auto &e) { return live().ids.count(e.first) == 0; }),
+                      entries.end());
+    }
+
+  private:
+    struct Live
+    {
+        std::mutex mutex;
+        std::unordered_set<std::uint64_t> ids;
+    };
+    static std::atomic<std::uint64_t> &next()
+    {
+        static std::atomic<std::uint64_t> counter{1};
+        return counter;
+    }
+    static Live &live()
+    {
+        // never destroyed: loggers held in statics outlive it otherwise
+        static Live *ids = new Live;
+        return *ids;
+    }
+
+    const std::uint64_t _id;
+};
+
 /*
  * Logger Class Features:
  * 1. Asynchronous Logging: Background thread processes entries for improved performance
@@ -54,29 +136,113 @@ namespace zerg
  * 4. Batched Processing: Groups log entries to reduce I/O operations and lock contention
  * 5. Safe Shutdown: Ensures all pending logs are written before destruction @sync
  * 6. Thread-Safe: File operations protected by mutex, queue operations lock-free
- * 7. File Rotation: Automatic log file rotation when size limit reached @rotateLogFile
+ * 7. File Rotation: Automatic log file rotation when size limit reached, old segments deleted
+ * in the background by RetentionManager @rotateLogFile @setRetention
+ * 8. Parallel Formatting: Optional formatter threads with an order preserving writer
+ * @setFormatterThreads
+ * 9. Pooled Backend: Optionally drained by a shared BackendPool instead of its own thread @_pool
+ * 10. Busy Poll: Optional spinning backend with TSC timestamps, no producer syscalls
+ * @enableBusyPoll
+ * 11. Sequence Numbers: Optional per-logger and per-thread record sequence
+ * @setSequenceNumbers
+ * 12. Durable Journal: Optional crash surviving mmap journal of accepted records @enableJournal
+ * 13. Fork Safety: Drained before fork(), backend restarted in parent and child @prepareFork
+ * 14. Bounded Shutdown: zerg::shutdown(deadline) drains all loggers in parallel @drainBy
+ * 15. External Rotation: file reopened before the next write after requestReopen (SIGHUP)
+ * @reopen
+ * 16. Degraded Mode: on write errors DEBUG/INFO are shed unformatted, WARN+ held in memory
+ * until a backoff probe succeeds @probeBackend
+ * 17. Rate Quotas: lock-free byte and record token buckets checked before formatting
+ * @setQuota
  */
 
-template <std::size_t MaxFileSize, std::size_t BufferSize = MAX_FILE_SIZE> class Logger
+template <std::size_t MaxFileSize, std::size_t BufferSize = MAX_FILE_SIZE>
+class Logger : private PoolTask, private ForkAware, private Drainable
 {
   public:
+    // with a pool no backend thread is started, the pool must outlive the logger
     explicit Logger(std::string filename, const Verbosity logLevel = Verbosity::DEBUG_LVL,
-                    std::unique_ptr<ILogBackend> backend = nullptr);
+                    std::unique_ptr<ILogBackend> backend = nullptr, BackendPool *pool = nullptr);
     ~Logger();
 
+    // not movable either: the backend thread, the fork and drain registries and the pool
+    // all hold on to this
     Logger(const Logger &) = delete;
     Logger &operator=(const Logger &) = delete;
-    Logger(Logger &&other) noexcept;
-    Logger &operator=(Logger &&other) noexcept;
+    Logger(Logger &&) = delete;
+    Logger &operator=(Logger &&) = delete;
 
     void setLogLevel(Verbosity level);
 
     template <typename... Args>
     void log(Verbosity level, const char *file, int line, const char *format, Args &&...args);
 
+    // type erased log, arguments already packed (fmt::make_format_args, dynamic_format_arg_store)
+    void vlog(Verbosity level, const char *file, int line, const char *format,
+              fmt::format_args args);
+
+    // format drained batches on this many extra threads, 0 formats on the backend thread
+    void setFormatterThreads(std::size_t threads);
+
+    // Switch the backend thread to spin on the queue (pinned to cpu when >= 0) and stamp
+    // records with the TSC on the producer side. Producers then never notify _cv. One way,
+    // meant to be called once before logging starts, on an isolated core. Throws
+    // std::runtime_error, with the logger left as it was, if the thread cannot be pinned
+    void enableBusyPoll(int cpu = -1);
+
+    // stamp records on the producer (TscClock) and print microseconds, for output that is
+    // merged across files afterwards (see PerThreadLogger and zerg-merge)
+    void setFineTimestamps(bool enabled);
+
+    // Print "#<seq>" (per-logger sequence, the queue ticket, so total order can be restored
+    // across shards and lanes) and/or "t<thread>:<seq>" (per-thread sequence counted before
+    // the enqueue, so records dropped on a full queue show up as gaps)
+    void setSequenceNumbers(bool global, bool per_thread = false);
+
+    // Keep every accepted record in a crash surviving journal at path (see DurableJournal)
+    // until the backend has flushed it; records a killed process left there are written out
+    // first. Call once, before logging starts. A full journal rejects records like a full
+    // queue. Throws std::runtime_error if the journal cannot be opened
+    void enableJournal(const std::string &path, std::size_t capacity = JOURNAL_CAPACITY);
+
+    // Keep at most policy.max_files rotated segments of this logger's file, max_bytes of them
+    // or none older than max_age. Enforced by RetentionManager after every rotation and once
+    // now, for segments of earlier runs
+    void setRetention(const RetentionPolicy &policy);
+
+    // after fork() the child writes to "<filename>.<pid>" through a FileLogBackend instead
+    // of appending to the parent's file (see also FileLogOptions::shared_append)
+    void setReopenOnFork(bool per_pid_file);
+
+    // close and reopen the file now, between two chunks; requestReopen() does the same for
+    // every logger from anywhere, including a signal handler
+    void reopen();
+
+    // record every accepted call into recorder, nullptr stops capture.
+    // The recorder must outlive the logger or be detached first
+    void setTraceRecorder(TraceRecorder *recorder);
+
     void sync();
     void waitUntilEmpty();
 
+    // records rejected because the queue was full
+    [[nodiscard]] std::size_t droppedCount() const;
+
+    // Limit this logger to quota.bytes_per_second / records_per_second. Checked in log()
+    // before anything is formatted, the size taken from estimateRecordSize; records over
+    // quota are rejected and counted in quotaViolations(). A disabled quota removes the limit
+    void setQuota(const LogQuota &quota);
+
+    // records rejected by the quota
+    [[nodiscard]] std::size_t quotaViolations() const;
+
+    // The backend reported a write error (disk full, I/O error): records below WARN are
+    // shed before formatting, the rest are held in memory (DEGRADED_BUFFER_SIZE) while the
+    // backend is reopened with growing backoff. On recovery the held records are written
+    // followed by a WARN summary of what was shed. Held records still unwritten at shutdown
+    // count as unwritten in its report; with a journal none are shed
+    [[nodiscard]] bool degraded() const;
+
   private:
     struct LogEntry
     {
@@ -85,12 +251,20 @@ template <std::size_t MaxFileSize, std::size_t BufferSize = MAX_FILE_SIZE> class
         int line{};
         const char *format{};
         std::string args;
+        std::uint64_t timestamp{}; // TscClock ticks, 0 = stamped when formatted
+        std::uint64_t sequence{};  // queue ticket, set when dequeued
+        std::uint64_t thread_sequence{};
+        std::uint32_t thread{}; // currentThreadIndex(), 0 = no per-thread sequence
+        std::int64_t wall_ns{}; // fixed wall clock (journal replay), overrides timestamp
+        std::uint64_t journal{DurableJournal::FULL}; // journal position, FULL = not journaled
     };
 
     std::string _filename;
     std::unique_ptr<ILogBackend> _backend;
     std::size_t _current_size{};
     std::atomic<Verbosity> _log_level{};
+    std::atomic<std::size_t> _dropped_count{0};
+    std::atomic<TraceRecorder *> _trace_recorder{nullptr};
     LockFreeQueue<LogEntry> _log_buffer;
     std::condition_variable _cv;
     std::thread _logging_thread;
@@ -99,14 +273,89 @@ template <std::size_t MaxFileSize, std::size_t BufferSize = MAX_FILE_SIZE> class
     mutable std::mutex _file_mutex;
     std::condition_variable _empty_cv;
     std::mutex _empty_mutex;
+    std::shared_ptr<FormatPool> _format_pool; // guarded by _log_mutex
+    BackendPool *_pool{nullptr};
+    // at most one pool task per logger: set by the producer that schedules it,
+    // cleared by the worker once the queue is drained
+    std::atomic<bool> _pool_scheduled{false};
+    std::atomic<int> _pool_active{0};
+    std::atomic<bool> _busy_poll{false};
+    std::atomic<bool> _fine_timestamps{false};
+    std::atomic<bool> _global_sequence{false};
+    std::atomic<bool> _thread_sequence{false};
+    const LoggerId _instance_id;
+    int _busy_poll_cpu{-1}; // guarded by _log_mutex until _busy_poll is set
+    std::unique_ptr<DurableJournal> _journal_owner; // guarded by _log_mutex
+    std::atomic<DurableJournal *> _journal{nullptr};
+    std::atomic<bool> _reopen_on_fork{false};
+    std::size_t _fork_formatters{0}; // formatter threads to bring back after fork
+    bool _fork_restart{false};       // the backend was running when the fork started
+    std::atomic<bool> _backend_stopped{false};
+    // rest of the batch the backend was working on when stopBackend cut it short, written
+    // first by drainQueue; handed over by the join (or _pool_active) in stopBackend
+    std::vector<LogEntry> _unfinished;
+    std::uint64_t _reopen_seen{reopenGeneration()}; // guarded by _file_mutex
+    RetentionPolicy _retention;                     // guarded by _file_mutex
+    std::atomic<bool> _quota_enabled{false};
+    RateQuota _quota;
+    std::atomic<bool> _degraded{false};
+    std::atomic<bool> _probe_pending{false};      // a low level record let through to probe
+    std::atomic<std::int64_t> _probe_at{0};       // steady clock ns of the next probe
+    std::atomic<std::size_t> _shed_count{0};      // records shed since degrading
+    std::chrono::milliseconds _probe_backoff{};   // guarded by _file_mutex
+    std::int64_t _degraded_since{};               // guarded by _file_mutex
+    bool _backend_failed{false}; // the backend threw, guarded by _file_mutex
+
+    // formatted records of one chunk, ends[i] is the end offset of record i in buffer
+    struct FormattedChunk
+    {
+        fmt::memory_buffer buffer;
+        std::vector<std::size_t> ends;
+        std::vector<RecordInfo> records;
+        std::vector<std::uint64_t> journal; // positions to mark done once written
+    };
+    FormattedChunk _held;         // degraded mode, guarded by _file_mutex
+    std::size_t _held_dropped{0}; // guarded by _file_mutex
 
+    void enqueueEntry(Verbosity level, const char *file, int line, const char *format,
+                      std::string &&args);
+    bool dequeueEntry(LogEntry &entry);
+    std::uint64_t nextThreadSequence();
+    void replayJournal(DurableJournal &journal);
     void rotateLogFile();
     void processLogQueue();
+    void busyPollQueue();
+    bool runPoolTask() override;
+    void schedulePool();
+    void detachPool();
+    void prepareFork() override;
+    void parentAfterFork() override;
+    void childAfterFork() override;
+    void stopBackend();
+    void restartBackend();
+    DrainResult drainBy(std::chrono::steady_clock::time_point deadline) override;
+    std::size_t drainQueue(std::chrono::steady_clock::time_point deadline,
+                           std::size_t limit = SIZE_MAX);
     void processLogEntry(const LogEntry &entry);
-    static std::string getCurrentTime();
+    std::size_t processBatch(const std::vector<LogEntry> &batch, FormatPool *pool,
+                             bool interruptible = false);
+    void keepUnfinished(std::vector<LogEntry> &batch, std::size_t written);
+    void formatEntry(const LogEntry &entry, FormattedChunk &chunk);
+    void writeChunk(const FormattedChunk &chunk);
+    void writeRecords(const FormattedChunk &chunk);
+    void releaseJournal(const FormattedChunk &chunk);
+    void reopenBackend();
+    bool backendGood() const;
+    bool admitDegraded();
+    void enterDegraded();
+    void holdChunk(const FormattedChunk &chunk);
+    void probeBackend(bool force = false);
+    static std::int64_t steadyNowNs();
+    static std::int64_t getCurrentTimeNs();
+    static std::string formatTimestamp(std::int64_t ns, bool fine);
     static std::string getVerbosityString(const Verbosity level);
     static std::string getFileName(const std::string &path);
-    void sanitizeString(fmt::memory_buffer &buffer);
+    static void sanitizeString(fmt::memory_buffer &buffer, std::size_t from = 0);
 };
 
 } // namespace zerg
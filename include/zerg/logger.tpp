@@ -30,7 +30,8 @@ namespace zerg
 
 template <std::size_t MaxFileSize, std::size_t BufferSize>
 Logger<MaxFileSize, BufferSize>::Logger(std::string filename, const Verbosity logLevel,
-                                        std::unique_ptr<ILogBackend> backend)
+                                        std::unique_ptr<ILogBackend> backend,
+                                        BackendPool *pool)
     : _filename(std::move(filename)),
       _log_level(logLevel),
       _log_buffer(BufferSize),
@@ -41,75 +42,281 @@ Logger<MaxFileSize, BufferSize>::Logger(std::string filename, const Verbosity lo
         backend = std::make_unique<FileLogBackend>(_filename);
     }
     _backend = std::move(backend);
-    _logging_thread = std::thread(&Logger::processLogQueue, this);
+    _pool = pool;
+    DrainRegistry::instance().add(this);
+    ForkRegistry::instance().add(this, ForkRegistry::LOGGER, [this] {
+        if (_pool == nullptr)
+        {
+            _logging_thread = std::thread(&Logger::processLogQueue, this);
+        }
+    });
 }
 
 template <std::size_t MaxFileSize, std::size_t BufferSize>
 Logger<MaxFileSize, BufferSize>::~Logger()
 {
-    sync();
-    _stop_logging = true;
-    _cv.notify_all();
-    if (_logging_thread.joinable())
+    ForkRegistry::instance().remove(this);
+    DrainRegistry::instance().remove(this);
+    // no producer is left by now, so no quiet period as in sync(): stop the backend and
+    // write out the rest on this thread
+    stopBackend();
+    if (const std::size_t held = drainQueue(std::chrono::steady_clock::time_point::max());
+        unlikely(held > 0))
     {
-        _logging_thread.join();
+        // only records held for a backend that never recovered are left at this point
+        std::cerr << "zerg: " << _filename << ": backend still failing, " << held
+                  << " held records not written"
+                  << (_journal.load(std::memory_order_relaxed) != nullptr
+                          ? " (kept in the journal)"
+                          : "")
+                  << std::endl;
     }
+    _stop_logging = true;
 }
 
 
 
 template <std::size_t MaxFileSize, std::size_t BufferSize>
-Logger<MaxFileSize, BufferSize>::Logger(Logger &&other) noexcept
-    : _filename(std::move(other._filename)), _backend(std::move(other._backend)),
-      _current_size(other._current_size), _log_buffer(std::move(other._log_buffer)),
-      _stop_logging(other._stop_logging.load())
-    {
-        _log_level.store(other._log_level.load());
-        other._current_size = 0;
-        other._stop_logging = true;
-    }
+void Logger<MaxFileSize, BufferSize>::setLogLevel(Verbosity level)
+{
+    _log_level.store(level, std::memory_order_relaxed);
+}
 
 template <std::size_t MaxFileSize, std::size_t BufferSize>
-Logger<MaxFileSize, BufferSize>& Logger<MaxFileSize, BufferSize>::operator=(Logger &&other) noexcept
+template <typename... Args>
+void Logger<MaxFileSize, BufferSize>::log(Verbosity level, const char *file, int line, const char *format, Args&&... args)
 {
-        if (this != &other)
+    if (likely(level >= _log_level.load(std::memory_order_relaxed)))
+    {
+        if (unlikely(_degraded.load(std::memory_order_relaxed)) && level < Verbosity::WARN_LVL &&
+            !admitDegraded())
         {
-            _filename = std::move(other._filename);
-            _backend = std::move(other._backend);
-            _current_size = other._current_size;
-            _log_buffer = std::move(other._log_buffer);
-            _stop_logging = other._stop_logging.load();
-            _log_level.store(other._log_level.load());
-            other._current_size = 0;
-            other._stop_logging = true;
+            return;
         }
-        return *this;
+        if (unlikely(_quota_enabled.load(std::memory_order_relaxed)) &&
+            !_quota.admit(estimateRecordSize(format, args...)))
+        {
+            return;
+        }
+        if (TraceRecorder *recorder = _trace_recorder.load(std::memory_order_relaxed);
+            unlikely(recorder != nullptr))
+        {
+            recorder->record(level, file, line, format, args...);
+        }
+        enqueueEntry(level, file, line, format,
+                     fmt::format(fmt::runtime(format), std::forward<Args>(args)...));
     }
+}
 
 template <std::size_t MaxFileSize, std::size_t BufferSize>
-void Logger<MaxFileSize, BufferSize>::setLogLevel(Verbosity level)
+void Logger<MaxFileSize, BufferSize>::vlog(Verbosity level, const char *file, int line,
+                                           const char *format, fmt::format_args args)
 {
-    _log_level.store(level, std::memory_order_relaxed);
+    if (likely(level >= _log_level.load(std::memory_order_relaxed)))
+    {
+        if (unlikely(_degraded.load(std::memory_order_relaxed)) && level < Verbosity::WARN_LVL &&
+            !admitDegraded())
+        {
+            return;
+        }
+        // the packed arguments are not sized, only the format string counts
+        if (unlikely(_quota_enabled.load(std::memory_order_relaxed)) &&
+            !_quota.admit(estimateRecordSize(format)))
+        {
+            return;
+        }
+        enqueueEntry(level, file, line, format, fmt::vformat(format, args));
+    }
 }
 
 template <std::size_t MaxFileSize, std::size_t BufferSize>
-template <typename... Args>
-void Logger<MaxFileSize, BufferSize>::log(Verbosity level, const char *file, int line, const char *format, Args&&... args)
+void Logger<MaxFileSize, BufferSize>::enqueueEntry(Verbosity level, const char *file, int line,
+                                                   const char *format, std::string &&args)
 {
-    if (likely(level >= _log_level.load(std::memory_order_relaxed)))
+    LogEntry entry;
+    entry.level = level;
+    entry.file = file;
+    entry.line = line;
+    entry.format = format;
+    entry.args = std::move(args);
+    const bool busy_poll = _busy_poll.load(std::memory_order_relaxed);
+    if (busy_poll || _fine_timestamps.load(std::memory_order_relaxed))
     {
-        LogEntry entry;
-        entry.level = level;
-        entry.file = file;
-        entry.line = line;
-        entry.format = format;
-        entry.args = fmt::format(fmt::runtime(format), std::forward<Args>(args)...);
+        entry.timestamp = TscClock::now();
+    }
+    if (unlikely(_thread_sequence.load(std::memory_order_relaxed)))
+    {
+        // counted even if the enqueue below fails, that is what makes drops visible
+        entry.thread = currentThreadIndex();
+        entry.thread_sequence = nextThreadSequence();
+    }
+    if (DurableJournal *journal = _journal.load(std::memory_order_acquire);
+        unlikely(journal != nullptr))
+    {
+        // accepted means journaled: a record that does not fit is rejected like a full queue
+        entry.journal = journal->append(level, file, line, getCurrentTimeNs(), entry.args);
+        if (entry.journal == DurableJournal::FULL)
+        {
+            _dropped_count.fetch_add(1, std::memory_order_relaxed);
+            return;
+        }
+    }
+    const std::uint64_t journal_position = entry.journal;
 
-        if (_log_buffer.enqueue(std::move(entry)))
+    if (_log_buffer.enqueue(std::move(entry)))
+    {
+        if (_pool != nullptr)
+        {
+            schedulePool();
+        }
+        else if (!busy_poll)
         {
             _cv.notify_one();
         }
     }
+    else
+    {
+        if (journal_position != DurableJournal::FULL)
+        {
+            _journal.load(std::memory_order_relaxed)->markDone(journal_position);
+        }
+        _dropped_count.fetch_add(1, std::memory_order_relaxed);
+    }
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::setFormatterThreads(std::size_t threads)
+{
+    auto pool = threads == 0 ? nullptr : std::make_shared<FormatPool>(threads);
+    std::lock_guard<std::mutex> lock(_log_mutex);
+    // the backend thread keeps its own reference to a pool for the batch in flight
+    _format_pool = std::move(pool);
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::enableBusyPoll(int cpu)
+{
+    if (_pool != nullptr)
+    {
+        throw std::runtime_error("Busy poll needs a dedicated backend thread");
+    }
+    // calibrate here, never on a producer
+    TscClock::instance();
+    {
+        std::lock_guard<std::mutex> lock(_log_mutex);
+        if (cpu >= 0 && _logging_thread.joinable())
+        {
+            // pin from here so a cpu the thread may not run on fails the call instead of
+            // leaving an unpinned core spinning; busyPollQueue pins restarted threads
+            cpu_set_t set;
+            CPU_ZERO(&set);
+            CPU_SET(cpu, &set);
+            if (const int error =
+                    pthread_setaffinity_np(_logging_thread.native_handle(), sizeof(set), &set);
+                error != 0)
+            {
+                throw std::runtime_error("Cannot pin the busy poll backend to cpu " +
+                                         std::to_string(cpu) + ": " + std::strerror(error));
+            }
+        }
+        _busy_poll_cpu = cpu;
+        _busy_poll.store(true, std::memory_order_relaxed);
+    }
+    _cv.notify_all();
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::setFineTimestamps(const bool enabled)
+{
+    TscClock::instance();
+    _fine_timestamps.store(enabled, std::memory_order_relaxed);
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::setSequenceNumbers(const bool global, const bool per_thread)
+{
+    _global_sequence.store(global, std::memory_order_relaxed);
+    _thread_sequence.store(per_thread, std::memory_order_relaxed);
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+std::uint64_t Logger<MaxFileSize, BufferSize>::nextThreadSequence()
+{
+    // per (thread, logger) counter, keyed by instance id as addresses get reused
+    thread_local std::vector<std::pair<std::uint64_t, std::uint64_t>> counters;
+    for (auto &[id, counter] : counters)
+    {
+        if (likely(id == _instance_id.value()))
+            return counter++;
+    }
+    // first record of this thread to this logger: forget the loggers destroyed since, or a
+    // thread serving short lived loggers keeps a counter for every one of them
+    LoggerId::eraseDead(counters);
+    counters.emplace_back(_instance_id.value(), 1);
+    return 0;
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+bool Logger<MaxFileSize, BufferSize>::dequeueEntry(LogEntry &entry)
+{
+    std::size_t ticket;
+    if (!_log_buffer.dequeue(entry, ticket))
+        return false;
+    entry.sequence = ticket;
+    return true;
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::enableJournal(const std::string &path,
+                                                    const std::size_t capacity)
+{
+    std::lock_guard<std::mutex> lock(_log_mutex);
+    if (_journal_owner)
+    {
+        throw std::runtime_error("Journal already enabled");
+    }
+    _journal_owner = std::make_unique<DurableJournal>(path, capacity);
+    replayJournal(*_journal_owner);
+    _journal.store(_journal_owner.get(), std::memory_order_release);
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::replayJournal(DurableJournal &journal)
+{
+    // records an earlier process accepted but died before writing, in their original order
+    const auto records = journal.pending();
+    FormattedChunk chunk;
+    for (const auto &record : records)
+    {
+        LogEntry entry;
+        entry.level = record.level;
+        entry.file = record.file.c_str();
+        entry.line = record.line;
+        entry.args = record.message;
+        entry.wall_ns = record.time_ns;
+        formatEntry(entry, chunk);
+    }
+    writeChunk(chunk);
+    {
+        std::lock_guard<std::mutex> lock(_file_mutex);
+        _backend->flush();
+    }
+    // a crash before this point replays them again: at least once, never lost
+    journal.clear();
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::reopen()
+{
+    std::lock_guard<std::mutex> lock(_file_mutex);
+    _reopen_seen = reopenGeneration();
+    reopenBackend();
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::setTraceRecorder(TraceRecorder *recorder)
+{
+    _trace_recorder.store(recorder, std::memory_order_relaxed);
 }
 
 template <std::size_t MaxFileSize, std::size_t BufferSize>
@@ -121,7 +328,10 @@ void Logger<MaxFileSize, BufferSize>::sync()
         _file_mutex,
         _empty_cv,
         _empty_mutex,
-        [this](const LogEntry &entry) { processLogEntry(entry); }
+        [this](LogEntry &entry, const std::size_t ticket) {
+            entry.sequence = ticket;
+            processLogEntry(entry);
+        }
     );
 }
 
@@ -131,18 +341,55 @@ void Logger<MaxFileSize, BufferSize>::waitUntilEmpty()
     ::zerg::waitUntilEmpty<LogEntry>(_log_buffer);
 }
 
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+std::size_t Logger<MaxFileSize, BufferSize>::droppedCount() const
+{
+    return _dropped_count.load(std::memory_order_relaxed);
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::setQuota(const LogQuota &quota)
+{
+    _quota.configure(quota);
+    _quota_enabled.store(quota.enabled(), std::memory_order_relaxed);
+}
 
-    /* TODO: implement log rotation in backend not here */ 
-    // Maybe add support for logrotate or similar 
-    //https://linux.die.net/man/8/logrotate
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+std::size_t Logger<MaxFileSize, BufferSize>::quotaViolations() const
+{
+    return _quota.violations();
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+bool Logger<MaxFileSize, BufferSize>::degraded() const
+{
+    return _degraded.load(std::memory_order_relaxed);
+}
+
+
+// The backend keeps the current file as a segment (FileLogBackend::rotate) and the
+// retention pass runs on the RetentionManager thread, never on this one.
+// External rotation (logrotate) goes through requestReopen() / reopen() instead
+//https://linux.die.net/man/8/logrotate
 template <std::size_t MaxFileSize, std::size_t BufferSize>
 void Logger<MaxFileSize, BufferSize>::rotateLogFile()
+{
+    bool rotated = false;
+    try
     {
-        // 
-        _backend = std::make_unique<FileLogBackend>(_filename);
-        _current_size = 0;
+        rotated = _backend->rotate();
+    }
+    catch (const std::exception &)
+    {
+        // like a failed reopen: writeChunk holds the chunk and degrades
+        _backend_failed = true;
     }
-    /* TODO: implement log rotation in backend not here */
+    if (rotated && _retention.enabled())
+    {
+        RetentionManager::instance().enforce(_filename, _retention);
+    }
+    _current_size = 0;
+}
 
 template <std::size_t MaxFileSize, std::size_t BufferSize>
 void Logger<MaxFileSize, BufferSize>::processLogQueue()
@@ -153,69 +400,694 @@ void Logger<MaxFileSize, BufferSize>::processLogQueue()
         {
             // wait until notified or stopped,  no longer polling
             _cv.wait(lock, [this] { 
-                return _stop_logging || !_log_buffer.isEmpty(); 
+                return _stop_logging || _busy_poll || !_log_buffer.isEmpty(); 
             });
             
             //assuming stopping t he logging is rare
             if (unlikely(_stop_logging)) break;
+            if (unlikely(_busy_poll.load(std::memory_order_relaxed)))
+            {
+                lock.unlock();
+                busyPollQueue();
+                return;
+            }
                 
             std::vector<LogEntry> batch;
             LogEntry entry;
             
         // batch of entries under lock
-        while (likely(_log_buffer.dequeue(entry)))
+        while (likely(dequeueEntry(entry)))
         {
             // prefetch the next entry - minimize cache misses
             PREFETCH(&_log_buffer);
             batch.push_back(std::move(entry));
         }
             // process batch without lock
+            std::shared_ptr<FormatPool> pool = _format_pool;
             lock.unlock();
-            for (const auto& batch_entry : batch) {
-                processLogEntry(batch_entry);
-            }
+            const std::size_t written = processBatch(batch, pool.get(), true);
             lock.lock();
+            if (unlikely(written < batch.size()))
+            {
+                keepUnfinished(batch, written);
+                break;
+            }
         }
     }
 
 template <std::size_t MaxFileSize, std::size_t BufferSize>
-void Logger<MaxFileSize, BufferSize>::processLogEntry(const LogEntry &entry)
+void Logger<MaxFileSize, BufferSize>::busyPollQueue()
+{
+    std::shared_ptr<FormatPool> pool;
+    int cpu = -1;
+    {
+        std::lock_guard<std::mutex> lock(_log_mutex);
+        cpu = _busy_poll_cpu;
+    }
+    if (cpu >= 0)
+    {
+        cpu_set_t set;
+        CPU_ZERO(&set);
+        CPU_SET(cpu, &set);
+        // enableBusyPoll checked the cpu, this is a thread restarted after fork or shutdown
+        if (const int error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+            error != 0)
+        {
+            std::cerr << "zerg: busy poll backend not pinned to cpu " << cpu << ": "
+                      << std::strerror(error) << std::endl;
+        }
+    }
+
+    std::vector<LogEntry> batch;
+    LogEntry entry;
+    while (likely(!_stop_logging.load(std::memory_order_relaxed)))
+    {
+        while (dequeueEntry(entry))
+        {
+            batch.push_back(std::move(entry));
+        }
+        if (batch.empty())
+        {
+            CPU_RELAX();
+            continue;
+        }
+        {
+            // backend side only, producers never touch _log_mutex in this mode
+            std::lock_guard<std::mutex> lock(_log_mutex);
+            pool = _format_pool;
+        }
+        const std::size_t written = processBatch(batch, pool.get(), true);
+        if (unlikely(written < batch.size()))
+        {
+            keepUnfinished(batch, written);
+            return;
+        }
+        batch.clear();
+    }
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::schedulePool()
+{
+    // pairs with the fence in runPoolTask: either the worker sees our entry after clearing
+    // _pool_scheduled, or we see the flag cleared and schedule the logger again
+    std::atomic_thread_fence(std::memory_order_seq_cst);
+    if (!_pool_scheduled.load(std::memory_order_relaxed) &&
+        !_pool_scheduled.exchange(true, std::memory_order_acq_rel))
+    {
+        _pool->schedule(this);
+    }
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+bool Logger<MaxFileSize, BufferSize>::runPoolTask()
+{
+    _pool_active.fetch_add(1, std::memory_order_acquire);
+
+    std::vector<LogEntry> batch;
+    LogEntry entry;
+    // stopBackend is waiting for this task: leave the queue to drainQueue
+    const bool stopping = _backend_stopped.load(std::memory_order_relaxed);
+    // bounded so one busy logger cannot starve the others sharing this worker
+    while (!stopping && batch.size() < POOL_DRAIN_BUDGET && dequeueEntry(entry))
+    {
+        batch.push_back(std::move(entry));
+    }
+    std::shared_ptr<FormatPool> format_pool;
+    {
+        std::lock_guard<std::mutex> lock(_log_mutex);
+        format_pool = _format_pool;
+    }
+    const std::size_t written = processBatch(batch, format_pool.get(), true);
+
+    bool more = batch.size() == POOL_DRAIN_BUDGET;
+    if (unlikely(written < batch.size()))
+    {
+        keepUnfinished(batch, written);
+        more = false;
+    }
+    if (!more)
+    {
+        _pool_scheduled.store(false, std::memory_order_seq_cst);
+        std::atomic_thread_fence(std::memory_order_seq_cst);
+        more = !_backend_stopped.load(std::memory_order_relaxed) && !_log_buffer.isEmpty() &&
+               !_pool_scheduled.exchange(true, std::memory_order_acq_rel);
+    }
+
+    // last access to this logger, the destructor may proceed once it reads zero
+    _pool_active.fetch_sub(1, std::memory_order_release);
+    return more;
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::detachPool()
+{
+    // claim the flag so nothing schedules us again, then wait out a worker still inside
+    // runPoolTask. A task still queued in the pool keeps the flag set until it has run
+    bool expected = false;
+    while (!_pool_scheduled.compare_exchange_weak(expected, true, std::memory_order_acq_rel))
+    {
+        expected = false;
+        std::this_thread::yield();
+    }
+    while (_pool_active.load(std::memory_order_acquire) != 0)
+    {
+        std::this_thread::yield();
+    }
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::setRetention(const RetentionPolicy &policy)
+{
+    std::lock_guard<std::mutex> lock(_file_mutex);
+    _retention = policy;
+    if (policy.enabled())
+    {
+        // segments left by earlier runs
+        RetentionManager::instance().enforce(_filename, policy);
+    }
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::setReopenOnFork(const bool per_pid_file)
+{
+    _reopen_on_fork.store(per_pid_file, std::memory_order_relaxed);
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::stopBackend()
+{
+    if (_backend_stopped.exchange(true))
+    {
+        return;
+    }
+    if (_pool != nullptr)
+    {
+        detachPool();
+        return;
+    }
+    {
+        // under the lock, or the thread could miss the notify between predicate and wait
+        std::lock_guard<std::mutex> lock(_log_mutex);
+        _stop_logging = true;
+    }
+    _cv.notify_all();
+    if (_logging_thread.joinable())
+    {
+        _logging_thread.join();
+    }
+    _stop_logging = false;
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::restartBackend()
+{
+    _backend_stopped.store(false);
+    if (_fork_formatters > 0)
+    {
+        setFormatterThreads(_fork_formatters);
+    }
+    if (_pool != nullptr)
+    {
+        // the pool's workers are back (restarted before us), give up the claim from detachPool
+        _pool_scheduled.store(false, std::memory_order_seq_cst);
+        if (!_log_buffer.isEmpty())
+        {
+            schedulePool();
+        }
+        return;
+    }
+    _logging_thread = std::thread(&Logger::processLogQueue, this);
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::prepareFork()
+{
+    // Nothing may be half done when the address space is copied: stop the backend, write
+    // out what it had not got to yet, stop the formatter threads and hold both locks over
+    // the fork. Producers keep going, what they enqueue now stays with the parent: only
+    // what is queued already is written here, or a busy producer could hold off the fork
+    // forever. After zerg::shutdown the backend stays stopped on both sides
+    _fork_restart = !_backend_stopped.load();
+    stopBackend();
+    drainQueue(std::chrono::steady_clock::time_point::max(), _log_buffer.size());
+
+    _log_mutex.lock();
+    _fork_formatters = _format_pool ? _format_pool->threads() : 0;
+    _format_pool.reset();
+    _file_mutex.lock();
+    _backend->flush();
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::parentAfterFork()
+{
+    _file_mutex.unlock();
+    _log_mutex.unlock();
+    if (_fork_restart)
+    {
+        restartBackend();
+    }
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::childAfterFork()
 {
-        fmt::memory_buffer log_entry_buffer; // buffer to hold the formatted log entry
-        // now format log entry directly into the buffer no string
-        fmt::format_to(std::back_inserter(log_entry_buffer), "{} [{}] {}:{} {}", getCurrentTime(), getVerbosityString(entry.level),
-                    getFileName(entry.file), entry.line, entry.args);
+    // records enqueued since prepareFork belong to the parent, and the threads that were
+    // enqueueing or waiting here do not exist in this process
+    _log_buffer.reset();
+    new (&_empty_mutex) std::mutex;
+    new (&_cv) std::condition_variable;
+    new (&_empty_cv) std::condition_variable;
+    // the mapping is shared with the parent, which keeps journaling into it
+    _journal.store(nullptr, std::memory_order_relaxed);
+    _journal_owner.reset();
+    if (_reopen_on_fork.load(std::memory_order_relaxed))
+    {
+        // the parent still owns the old backend's file and sidecars: leave it untouched
+        static_cast<void>(_backend.release());
+        _filename += "." + std::to_string(getpid());
+        _backend = std::make_unique<FileLogBackend>(_filename);
+        _current_size = 0;
+    }
+    _file_mutex.unlock();
+    _log_mutex.unlock();
+    if (_fork_restart)
+    {
+        restartBackend();
+    }
+}
 
-        sanitizeString(log_entry_buffer);
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+DrainResult
+Logger<MaxFileSize, BufferSize>::drainBy(const std::chrono::steady_clock::time_point deadline)
+{
+    stopBackend();
+    return {drainQueue(deadline), droppedCount()};
+}
 
-        // protect file ops with a mutex
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+std::size_t
+Logger<MaxFileSize, BufferSize>::drainQueue(const std::chrono::steady_clock::time_point deadline,
+                                            const std::size_t limit)
+{
+    // the backend is stopped, this thread is the only consumer besides a concurrent sync()
+    // limit bounds the records taken off the queue, the unfinished batch is always written
+    std::vector<LogEntry> unfinished = std::move(_unfinished);
+    _unfinished.clear();
+    std::size_t next = 0;
+    std::size_t taken = 0;
+    std::vector<LogEntry> batch;
+    LogEntry entry;
+    while (std::chrono::steady_clock::now() < deadline)
+    {
+        batch.clear();
+        // what the backend was stopped in the middle of comes before the queue
+        for (; next < unfinished.size() && batch.size() < SHUTDOWN_DRAIN_BATCH; ++next)
+        {
+            batch.push_back(std::move(unfinished[next]));
+        }
+        while (batch.size() < SHUTDOWN_DRAIN_BATCH && taken < limit && dequeueEntry(entry))
+        {
+            batch.push_back(std::move(entry));
+            ++taken;
+        }
+        processBatch(batch, nullptr);
+        if (batch.size() < SHUTDOWN_DRAIN_BATCH || (taken >= limit && next == unfinished.size()))
+        {
+            break;
+        }
+    }
+    std::size_t held = 0;
+    {
         std::lock_guard<std::mutex> lock(_file_mutex);
+        if (unlikely(_degraded.load(std::memory_order_relaxed)))
+        {
+            // no later chunk may come to retry the held records, try once more regardless
+            // of the backoff before counting them as unwritten
+            probeBackend(true);
+        }
+        _backend->flush();
+        held = _held.ends.size();
+    }
+    // past the deadline: kept for the destructor, still ahead of the queue
+    _unfinished.assign(std::make_move_iterator(unfinished.begin() + next),
+                       std::make_move_iterator(unfinished.end()));
+    return _unfinished.size() + _log_buffer.size() + held;
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::processLogEntry(const LogEntry &entry)
+{
+    FormattedChunk chunk;
+    formatEntry(entry, chunk);
+    writeChunk(chunk);
+}
 
-        if (_current_size + log_entry_buffer.size() > MaxFileSize)
+// Returns how many records of batch were written, all unless interruptible and stopBackend
+// was called: the backend thread then stops between two chunks, so a stop waits for one
+// chunk write at most and not for the whole batch
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+std::size_t Logger<MaxFileSize, BufferSize>::processBatch(const std::vector<LogEntry> &batch,
+                                                          FormatPool *pool,
+                                                          const bool interruptible)
+{
+    auto stopped = [&] {
+        return interruptible && unlikely(_backend_stopped.load(std::memory_order_relaxed));
+    };
+    if (pool == nullptr || batch.size() < 2 * PARALLEL_FORMAT_MIN_CHUNK)
+    {
+        FormattedChunk chunk;
+        for (std::size_t i = 0; i < batch.size(); ++i)
+        {
+            formatEntry(batch[i], chunk);
+            if (chunk.ends.size() == WRITE_CHUNK_RECORDS)
+            {
+                writeChunk(chunk);
+                chunk.buffer.clear();
+                chunk.ends.clear();
+                chunk.records.clear();
+                chunk.journal.clear();
+                if (stopped())
+                {
+                    return i + 1;
+                }
+            }
+        }
+        writeChunk(chunk);
+        return batch.size();
+    }
+
+    // pipelined: formatter threads fill disjoint chunks, this thread writes them in order
+    const std::size_t max_chunks = (batch.size() + PARALLEL_FORMAT_MIN_CHUNK - 1) /
+                                   PARALLEL_FORMAT_MIN_CHUNK;
+    const std::size_t chunk_count = std::min(max_chunks, 4 * pool->threads());
+    const std::size_t per_chunk = (batch.size() + chunk_count - 1) / chunk_count;
+    std::vector<FormattedChunk> chunks(chunk_count);
+    std::size_t written = batch.size();
+
+    pool->pipeline(
+        chunk_count,
+        [&](const std::size_t i) {
+            const std::size_t end = std::min(batch.size(), (i + 1) * per_chunk);
+            for (std::size_t e = i * per_chunk; e < end; ++e)
+            {
+                formatEntry(batch[e], chunks[i]);
+            }
+        },
+        [&](const std::size_t i) {
+            // chunks after a stop are formatted anyway but not written
+            if (written == batch.size() && i > 0 && stopped())
+            {
+                written = std::min(batch.size(), i * per_chunk);
+            }
+            if (written == batch.size())
+            {
+                writeChunk(chunks[i]);
+            }
+        });
+    return written;
+}
+
+// backend side, before its thread exits or the pool task returns
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::keepUnfinished(std::vector<LogEntry> &batch,
+                                                     const std::size_t written)
+{
+    _unfinished.insert(_unfinished.end(), std::make_move_iterator(batch.begin() + written),
+                       std::make_move_iterator(batch.end()));
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::formatEntry(const LogEntry &entry, FormattedChunk &chunk)
+{
+    const std::size_t start = chunk.buffer.size();
+    // format log entry directly into the chunk buffer, no intermediate string
+    auto out = std::back_inserter(chunk.buffer);
+    std::int64_t time_ns = entry.wall_ns;
+    if (time_ns == 0)
+    {
+        time_ns = entry.timestamp != 0 ? TscClock::instance().toRealtimeNs(entry.timestamp)
+                                       : getCurrentTimeNs();
+    }
+    fmt::format_to(out, "{} [{}] ",
+                   formatTimestamp(time_ns, _fine_timestamps.load(std::memory_order_relaxed)),
+                   getVerbosityString(entry.level));
+    if (unlikely(_global_sequence.load(std::memory_order_relaxed)))
+    {
+        fmt::format_to(out, "#{} ", entry.sequence);
+    }
+    if (unlikely(entry.thread != 0))
+    {
+        fmt::format_to(out, "t{}:{} ", entry.thread, entry.thread_sequence);
+    }
+    fmt::format_to(out, "{}:{} {}", getFileName(entry.file), entry.line, entry.args);
+
+    sanitizeString(chunk.buffer, start);
+    chunk.ends.push_back(chunk.buffer.size());
+    chunk.records.push_back({time_ns, entry.sequence});
+    if (unlikely(entry.journal != DurableJournal::FULL))
+    {
+        chunk.journal.push_back(entry.journal);
+    }
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::writeChunk(const FormattedChunk &chunk)
+{
+    if (chunk.ends.empty())
+        return;
+
+    // protect file ops with a mutex, once per chunk rather than per record
+    std::lock_guard<std::mutex> lock(_file_mutex);
+
+    const std::uint64_t generation = reopenGeneration();
+    if (unlikely(generation != _reopen_seen))
+    {
+        // external rotation: the whole chunk goes to the new file
+        _reopen_seen = generation;
+        reopenBackend();
+    }
+    if (unlikely(_degraded.load(std::memory_order_relaxed)))
+    {
+        holdChunk(chunk);
+        probeBackend();
+        return;
+    }
+
+    writeRecords(chunk);
+    if (unlikely(!chunk.journal.empty()))
+    {
+        // the records have to reach the kernel before the journal lets go of them
+        _backend->flush();
+    }
+    if (unlikely(!backendGood()))
+    {
+        // Which of the records still in the stream buffer made it out is unknown, this
+        // chunk is held and written again, so a few records can show up twice
+        enterDegraded();
+        holdChunk(chunk);
+        return;
+    }
+    releaseJournal(chunk);
+}
+
+// caller holds _file_mutex
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::writeRecords(const FormattedChunk &chunk)
+{
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < chunk.ends.size(); ++i)
+    {
+        const std::size_t size = chunk.ends[i] - start;
+        if (_current_size + size > MaxFileSize)
         {
             rotateLogFile();
         }
-        _backend->write(log_entry_buffer.data(), static_cast<std::streamsize>(log_entry_buffer.size()));
-        _backend->writeNewline();
-        _current_size += log_entry_buffer.size();
+        _backend->writeRecord(chunk.buffer.data() + start, static_cast<std::streamsize>(size),
+                              chunk.records[i]);
+        _current_size += size;
+        start = chunk.ends[i];
     }
+}
 
+// the chunk is flushed, caller holds _file_mutex
 template <std::size_t MaxFileSize, std::size_t BufferSize>
-std::string Logger<MaxFileSize, BufferSize>::getCurrentTime()
+void Logger<MaxFileSize, BufferSize>::releaseJournal(const FormattedChunk &chunk)
+{
+    if (unlikely(!chunk.journal.empty()))
+    {
+        DurableJournal *journal = _journal.load(std::memory_order_relaxed);
+        for (const auto position : chunk.journal)
+        {
+            journal->markDone(position);
+        }
+        journal->reclaim();
+    }
+}
+
+// Caller holds _file_mutex. Runs on the backend thread for requestReopen() and probes: a
+// backend that throws is taken as failed, the next chunk degrades the logger
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::reopenBackend()
+{
+    _backend_failed = false;
+    try
+    {
+        _backend->reopen();
+    }
+    catch (const std::exception &)
+    {
+        _backend_failed = true;
+    }
+    _current_size = 0;
+}
+
+// caller holds _file_mutex
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+bool Logger<MaxFileSize, BufferSize>::backendGood() const
+{
+    return !_backend_failed && _backend->good();
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+bool Logger<MaxFileSize, BufferSize>::admitDegraded()
+{
+    // One record per probe interval goes through anyway: a logger that only logs below
+    // WARN would otherwise never reach the backend again to find out it recovered
+    if (steadyNowNs() >= _probe_at.load(std::memory_order_relaxed) &&
+        !_probe_pending.load(std::memory_order_relaxed) &&
+        !_probe_pending.exchange(true, std::memory_order_relaxed))
+    {
+        return true;
+    }
+    _shed_count.fetch_add(1, std::memory_order_relaxed);
+    return false;
+}
+
+// caller holds _file_mutex
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::enterDegraded()
+{
+    _degraded_since = steadyNowNs();
+    _probe_backoff = std::chrono::milliseconds(DEGRADED_PROBE_MIN_MS);
+    _probe_at.store(_degraded_since + std::chrono::nanoseconds(_probe_backoff).count(),
+                    std::memory_order_relaxed);
+    _held_dropped = 0;
+    // reset before producers can see the flag and start counting
+    _shed_count.store(0, std::memory_order_relaxed);
+    _degraded.store(true, std::memory_order_relaxed);
+}
+
+// caller holds _file_mutex
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::holdChunk(const FormattedChunk &chunk)
+{
+    // The oldest records are kept, what does not fit any more is shed. Journaled records are
+    // never shed: their positions are only marked done once written, and each one already
+    // takes journal space, so the journal's capacity bounds what is held
+    const bool journaled = !chunk.journal.empty();
+    std::size_t start = 0;
+    for (std::size_t i = 0; i < chunk.ends.size(); ++i)
+    {
+        if (!journaled && _held.buffer.size() + chunk.ends[i] - start > DEGRADED_BUFFER_SIZE)
+        {
+            _held_dropped += chunk.ends.size() - i;
+            break;
+        }
+        _held.buffer.append(chunk.buffer.data() + start, chunk.buffer.data() + chunk.ends[i]);
+        _held.ends.push_back(_held.buffer.size());
+        _held.records.push_back(chunk.records[i]);
+        start = chunk.ends[i];
+    }
+    _held.journal.insert(_held.journal.end(), chunk.journal.begin(), chunk.journal.end());
+}
+
+// caller holds _file_mutex
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+void Logger<MaxFileSize, BufferSize>::probeBackend(const bool force)
+{
+    const std::int64_t now = steadyNowNs();
+    if (!force && now < _probe_at.load(std::memory_order_relaxed))
+    {
+        return;
+    }
+    reopenBackend();
+    writeRecords(_held);
+    _backend->flush();
+    if (!backendGood())
+    {
+        _probe_backoff = std::min(2 * _probe_backoff,
+                                  std::chrono::milliseconds(DEGRADED_PROBE_MAX_MS));
+        _probe_at.store(now + std::chrono::nanoseconds(_probe_backoff).count(),
+                        std::memory_order_relaxed);
+        _probe_pending.store(false, std::memory_order_relaxed);
+        return;
+    }
+
+    releaseJournal(_held);
+    const std::size_t written = _held.ends.size();
+    _held.buffer.clear();
+    _held.ends.clear();
+    _held.records.clear();
+    _held.journal.clear();
+    _degraded.store(false, std::memory_order_relaxed);
+    _probe_pending.store(false, std::memory_order_relaxed);
+
+    // written here rather than queued: a probe run by the destructor's drain would leave a
+    // queued summary behind
+    LogEntry summary;
+    summary.level = Verbosity::WARN_LVL;
+    summary.file = __FILE__;
+    summary.line = __LINE__;
+    summary.args = fmt::format("backend recovered after {} ms: shed {} records below WARN, "
+                               "wrote {} held records, shed {} that did not fit",
+                               (now - _degraded_since) / 1000000,
+                               _shed_count.load(std::memory_order_relaxed), written,
+                               _held_dropped);
+    FormattedChunk chunk;
+    formatEntry(summary, chunk);
+    writeRecords(chunk);
+    _backend->flush();
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+std::int64_t Logger<MaxFileSize, BufferSize>::steadyNowNs()
+{
+    return std::chrono::duration_cast<std::chrono::nanoseconds>(
+               std::chrono::steady_clock::now().time_since_epoch())
+        .count();
+}
+
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+std::int64_t Logger<MaxFileSize, BufferSize>::getCurrentTimeNs()
 {
         struct timespec ts;
         // Using clock_gettime w/ CLOCK_REALTIME_COARSE (linux) for a faster timestamp
         // https://www.man7.org/linux/man-pages/man3/clock_gettime.3.html
         clock_gettime(CLOCK_REALTIME_COARSE, &ts);
-        std::tm tm_time{};
-        localtime_r(&ts.tv_sec, &tm_time);
-        char buffer[32];
-        // std::strftime to format the time into the fixed-size buffer. 
-        // Reduced allocations I think?
-        std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %X", &tm_time);
-        return buffer;
+        return static_cast<std::int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
     }
 
+template <std::size_t MaxFileSize, std::size_t BufferSize>
+std::string Logger<MaxFileSize, BufferSize>::formatTimestamp(const std::int64_t ns,
+                                                             const bool fine)
+{
+    // optional microseconds keep the text sortable by timestamp
+    const time_t seconds = static_cast<time_t>(ns / 1000000000LL);
+    std::tm tm_time{};
+    localtime_r(&seconds, &tm_time);
+    char buffer[40];
+    // std::strftime to format the time into the fixed-size buffer.
+    const std::size_t length = std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %X", &tm_time);
+    if (fine)
+    {
+        std::snprintf(buffer + length, sizeof(buffer) - length, ".%06d",
+                      static_cast<int>((ns % 1000000000LL) / 1000));
+    }
+    return buffer;
+}
+
 template <std::size_t MaxFileSize, std::size_t BufferSize>
 std::string Logger<MaxFileSize, BufferSize>::getVerbosityString(const Verbosity level)
 {
@@ -244,10 +1116,10 @@ std::string Logger<MaxFileSize, BufferSize>::getFileName(const std::string &path
     }
 
 template <std::size_t MaxFileSize, std::size_t BufferSize>
-void Logger<MaxFileSize, BufferSize>::sanitizeString(fmt::memory_buffer &buffer)
+void Logger<MaxFileSize, BufferSize>::sanitizeString(fmt::memory_buffer &buffer, std::size_t from)
 {
         //remove non-printable characters from the buffer
-        auto it = std::remove_if(buffer.begin(), buffer.end(),
+        auto it = std::remove_if(buffer.begin() + from, buffer.end(),
                                 [](unsigned char c) { return std::isprint(c) == 0; });
         // resize to remove the unwanted characters
         buffer.resize(it - buffer.begin());
@@ -30,10 +30,13 @@
 // This is easier in 20 [[likely]] and [[unlikely]] attributes
 #define likely(x) __builtin_expect(!!(x), 1)
 #define unlikely(x) __builtin_expect(!!(x), 0)
+// spin-wait hint, eases the pipeline and the sibling hyperthread while polling
+#define CPU_RELAX() _mm_pause()
 #else
 #define PREFETCH(addr)
 #define likely(x) (x)
 #define unlikely(x) (x)
+#define CPU_RELAX()
 #endif
 
 #endif // MACROS_HPP
\ No newline at end of file
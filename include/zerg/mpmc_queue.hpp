@@ -102,6 +102,14 @@ template <typename T> class LockFreeQueue
 
   public:
     [[nodiscard]] bool dequeue(T &item)
+    {
+        size_t ticket;
+        return dequeue(item, ticket);
+    }
+
+    // ticket is the position the item was enqueued at: consecutive, in enqueue order,
+    // and shared by all producers, so it doubles as a free sequence number
+    [[nodiscard]] bool dequeue(T &item, size_t &ticket)
     {
         for (;;)
         {
@@ -124,11 +132,25 @@ template <typename T> class LockFreeQueue
                 ptr->~T();
                 // mark the slot empty
                 _slots[idx].turn.store(2 * (turn + 1), std::memory_order_release);
+                ticket = tail;
                 return true;
             }
         }
     }
 
+    // Forget every item, for a forked child whose producers and consumers were left behind
+    // mid-operation. Items are abandoned rather than destroyed: a slot may hold one that a
+    // vanished thread had half constructed or half moved out. Single threaded only
+    void reset()
+    {
+        for (auto &slot : _slots)
+        {
+            slot.turn.store(0, std::memory_order_relaxed);
+        }
+        _head.value.store(0, std::memory_order_relaxed);
+        _tail.value.store(0, std::memory_order_relaxed);
+    }
+
     [[nodiscard]] size_t capacity() const { return _capacity; } // get capacity of queue
 
     [[nodiscard]] bool isEmpty() const
@@ -0,0 +1,175 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RATE_QUOTA_HPP
+#define RATE_QUOTA_HPP
+
+#include "constants.hpp" // CACHE_LINE_SIZE, QUOTA_RECORD_OVERHEAD, QUOTA_ARG_ESTIMATE
+
+#include <algorithm>   // std::max
+#include <atomic>      // std::atomic
+#include <chrono>      // std::chrono::milliseconds
+#include <cstdint>     // std::uint64_t, std::int64_t
+#include <cstring>     // std::strlen
+#include <string_view> // std::string_view
+#include <time.h>      // clock_gettime, CLOCK_MONOTONIC_COARSE
+#include <type_traits> // std::decay_t, std::is_array_v, std::is_same_v
+
+namespace zerg
+{
+
+// per logger limits, 0 = unlimited. burst is how much of the rate can be spent at once
+// after an idle period
+struct LogQuota
+{
+    std::uint64_t bytes_per_second = 0;
+    std::uint64_t records_per_second = 0;
+    std::chrono::milliseconds burst{1000};
+
+    [[nodiscard]] bool enabled() const { return bytes_per_second != 0 || records_per_second != 0; }
+};
+
+/*
+ * Token bucket as GCRA: the whole state is one "theoretical arrival time", how far the
+ * bucket has been spent into the future. Taking tokens is one CAS moving it forward by
+ * units / rate; a request that would move it more than the burst past now is refused.
+ * An idle bucket admits one request of any size, so a record larger than the burst still
+ * gets through now and then instead of never.
+ */
+class TokenBucket
+{
+  public:
+    // not synchronised with tryAcquire beyond each field being atomic, meant for setup
+    void configure(const std::uint64_t per_second, const std::chrono::nanoseconds burst)
+    {
+        _rate.store(per_second, std::memory_order_relaxed);
+        _tolerance_ns.store(burst.count(), std::memory_order_relaxed);
+        _tat.store(0, std::memory_order_relaxed);
+    }
+
+    bool tryAcquire(const std::uint64_t units, const std::int64_t now_ns)
+    {
+        const std::uint64_t rate = _rate.load(std::memory_order_relaxed);
+        if (rate == 0)
+            return true;
+        const std::int64_t cost = costNs(units, rate);
+        const std::int64_t tolerance = _tolerance_ns.load(std::memory_order_relaxed);
+        std::int64_t tat = _tat.load(std::memory_order_relaxed);
+        for (;;)
+        {
+            const std::int64_t next = std::max(tat, now_ns) + cost;
+            if (next - now_ns > tolerance && tat > now_ns)
+                return false;
+            if (_tat.compare_exchange_weak(tat, next, std::memory_order_relaxed))
+                return true;
+        }
+    }
+
+    // give back what tryAcquire took, when a second bucket refused the same request
+    void refund(const std::uint64_t units)
+    {
+        const std::uint64_t rate = _rate.load(std::memory_order_relaxed);
+        if (rate != 0)
+            _tat.fetch_sub(costNs(units, rate), std::memory_order_relaxed);
+    }
+
+  private:
+    static std::int64_t costNs(const std::uint64_t units, const std::uint64_t rate)
+    {
+        return static_cast<std::int64_t>(units * 1000000000ULL / rate);
+    }
+
+    // contended by every producer of the logger, kept off the logger's other fields
+    alignas(CACHE_LINE_SIZE) std::atomic<std::int64_t> _tat{0};
+    std::atomic<std::uint64_t> _rate{0};
+    std::atomic<std::int64_t> _tolerance_ns{0};
+};
+
+namespace quota_detail
+{
+template <typename T> std::size_t argSize(const T &arg)
+{
+    using Type = std::decay_t<T>;
+    if constexpr (std::is_array_v<T>)
+        return std::strlen(arg);
+    else if constexpr (std::is_same_v<Type, const char *> || std::is_same_v<Type, char *>)
+        return arg != nullptr ? std::strlen(arg) : 0;
+    else if constexpr (std::is_convertible_v<const T &, std::string_view>)
+        return std::string_view(arg).size();
+    else
+        return QUOTA_ARG_ESTIMATE;
+}
+} // namespace quota_detail
+
+// Bytes a record will take, known before formatting: the format string, string arguments
+// at their length, anything else at QUOTA_ARG_ESTIMATE, plus timestamp, level and location
+template <typename... Args>
+std::size_t estimateRecordSize(const char *format, const Args &...args)
+{
+    return QUOTA_RECORD_OVERHEAD + std::strlen(format) +
+           (std::size_t{0} + ... + quota_detail::argSize(args));
+}
+
+// record and byte bucket of one logger
+class RateQuota
+{
+  public:
+    void configure(const LogQuota &quota)
+    {
+        const std::chrono::nanoseconds burst = quota.burst;
+        _bytes.configure(quota.bytes_per_second, burst);
+        _records.configure(quota.records_per_second, burst);
+    }
+
+    // false (and counted) if the record is over quota
+    bool admit(const std::size_t bytes)
+    {
+        struct timespec ts;
+        // coarse is plenty for rates, and stays in the vDSO
+        clock_gettime(CLOCK_MONOTONIC_COARSE, &ts);
+        const std::int64_t now = static_cast<std::int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+        if (!_records.tryAcquire(1, now))
+        {
+            _violations.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        if (!_bytes.tryAcquire(bytes, now))
+        {
+            _records.refund(1);
+            _violations.fetch_add(1, std::memory_order_relaxed);
+            return false;
+        }
+        return true;
+    }
+
+    [[nodiscard]] std::size_t violations() const
+    {
+        return _violations.load(std::memory_order_relaxed);
+    }
+
+  private:
+    TokenBucket _records;
+    TokenBucket _bytes;
+    std::atomic<std::size_t> _violations{0};
+};
+
+} // namespace zerg
+
+#endif // RATE_QUOTA_HPP
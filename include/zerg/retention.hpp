@@ -0,0 +1,277 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef RETENTION_HPP
+#define RETENTION_HPP
+
+#include "constants.hpp"           // RETENTION_TRUNCATE_STEP
+#include "fork_safety.hpp"         // ForkAware, ForkRegistry
+#include "backend/log_segment.hpp" // isRotatedSegment
+
+#include <algorithm>          // std::sort
+#include <atomic>             // std::atomic
+#include <chrono>             // std::chrono::seconds
+#include <condition_variable> // std::condition_variable
+#include <cstdint>            // std::uint64_t
+#include <ctime>              // std::time
+#include <deque>              // std::deque
+#include <dirent.h>           // opendir, readdir, dirfd
+#include <fcntl.h>            // openat, AT_SYMLINK_NOFOLLOW
+#include <mutex>              // std::mutex, std::unique_lock
+#include <string>             // std::string
+#include <sys/stat.h>         // fstatat
+#include <thread>             // std::thread
+#include <unistd.h>           // unlinkat, ftruncate
+#include <utility>            // std::pair
+#include <vector>             // std::vector
+
+namespace zerg
+{
+
+// limits on the rotated segments of one log (see FileLogBackend::rotate), 0 = no limit.
+// The live file is never deleted
+struct RetentionPolicy
+{
+    std::size_t max_files = 0;
+    // segments and their sidecars together
+    std::uint64_t max_bytes = 0;
+    // by modification time, which is when the segment was rotated
+    std::chrono::seconds max_age{0};
+
+    [[nodiscard]] bool enabled() const
+    {
+        return max_files != 0 || max_bytes != 0 || max_age.count() != 0;
+    }
+};
+
+/*
+ * Deletes expired segments on its own thread, oldest first, with unlinkat relative to the
+ * log's directory. Loggers only queue a pass after a rotation, so no backend thread ever
+ * waits for the filesystem: freeing the extents of a large file can hold the ext4 journal
+ * for hundreds of milliseconds and stall every writer on the disk. Large files are
+ * therefore shrunk in RETENTION_TRUNCATE_STEP steps before the unlink, each step a short
+ * transaction of its own.
+ * The thread is started on the first pass, stopped before fork() and restarted in the
+ * parent only (ForkRegistry); passes still queued belong to the parent.
+ */
+class RetentionManager : private ForkAware
+{
+  public:
+    static RetentionManager &instance()
+    {
+        // never destroyed: loggers may still rotate while static destructors run
+        static RetentionManager *manager = new RetentionManager;
+        return *manager;
+    }
+
+    RetentionManager(const RetentionManager &) = delete;
+    RetentionManager &operator=(const RetentionManager &) = delete;
+
+    // queue a pass over the rotated segments of log_path and return at once; a pass for
+    // the same log still waiting is updated instead of queued twice
+    void enforce(const std::string &log_path, const RetentionPolicy &policy)
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            for (auto &pending : _pending)
+            {
+                if (pending.first == log_path)
+                {
+                    pending.second = policy;
+                    return;
+                }
+            }
+            _pending.emplace_back(log_path, policy);
+            if (!_worker.joinable())
+                _worker = std::thread(&RetentionManager::workerLoop, this);
+        }
+        _cv.notify_one();
+    }
+
+    // block until every queued pass is done
+    void wait()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        _done_cv.wait(lock, [this] { return _pending.empty() && !_busy; });
+    }
+
+    // segments deleted since the process started
+    [[nodiscard]] std::size_t deletedSegments() const
+    {
+        return _deleted.load(std::memory_order_relaxed);
+    }
+
+  private:
+    RetentionManager()
+    {
+        ForkRegistry::instance().add(this, ForkRegistry::POOL, [] {});
+    }
+
+    struct Segment
+    {
+        std::string name;
+        std::uint64_t bytes{};
+        time_t modified{};
+    };
+
+    void workerLoop()
+    {
+        std::unique_lock<std::mutex> lock(_mutex);
+        for (;;)
+        {
+            _cv.wait(lock, [this] { return _stop || !_pending.empty(); });
+            if (_stop)
+                return;
+            const auto pass = std::move(_pending.front());
+            _pending.pop_front();
+            _busy = true;
+            lock.unlock();
+            const std::size_t deleted = removeExpired(pass.first, pass.second);
+            _deleted.fetch_add(deleted, std::memory_order_relaxed);
+            lock.lock();
+            _busy = false;
+            if (_pending.empty())
+                _done_cv.notify_all();
+        }
+    }
+
+    static std::size_t removeExpired(const std::string &log_path, const RetentionPolicy &policy)
+    {
+        const auto slash = log_path.rfind('/');
+        std::string directory = ".";
+        if (slash != std::string::npos)
+            directory = slash == 0 ? "/" : log_path.substr(0, slash);
+        const std::string base = slash == std::string::npos ? log_path : log_path.substr(slash + 1);
+
+        DIR *dir = opendir(directory.c_str());
+        if (dir == nullptr)
+            return 0;
+        const int fd = dirfd(dir);
+        std::vector<Segment> segments;
+        while (const dirent *entry = readdir(dir))
+        {
+            struct stat st;
+            if (!isRotatedSegment(entry->d_name, base) ||
+                fstatat(fd, entry->d_name, &st, AT_SYMLINK_NOFOLLOW) != 0 || !S_ISREG(st.st_mode))
+            {
+                continue;
+            }
+            Segment segment{entry->d_name, static_cast<std::uint64_t>(st.st_size), st.st_mtime};
+            for (const char *sidecar : {".idx", ".bloom"})
+            {
+                if (fstatat(fd, (segment.name + sidecar).c_str(), &st, AT_SYMLINK_NOFOLLOW) == 0)
+                    segment.bytes += static_cast<std::uint64_t>(st.st_size);
+            }
+            segments.push_back(std::move(segment));
+        }
+
+        // the names sort by rotation time
+        std::sort(segments.begin(), segments.end(),
+                  [](const Segment &a, const Segment &b) { return a.name < b.name; });
+        std::uint64_t total = 0;
+        for (const auto &segment : segments)
+            total += segment.bytes;
+        const time_t now = std::time(nullptr);
+        std::size_t deleted = 0;
+        for (std::size_t i = 0; i < segments.size(); ++i)
+        {
+            const Segment &segment = segments[i];
+            const bool expired =
+                (policy.max_files != 0 && segments.size() - i > policy.max_files) ||
+                (policy.max_bytes != 0 && total > policy.max_bytes) ||
+                (policy.max_age.count() != 0 && now - segment.modified > policy.max_age.count());
+            if (!expired)
+                break;
+            // sidecars first, a segment without them is still searchable by a full scan
+            for (const char *sidecar : {".idx", ".bloom"})
+                unlinkat(fd, (segment.name + sidecar).c_str(), 0);
+            shrink(fd, segment.name);
+            if (unlinkat(fd, segment.name.c_str(), 0) == 0)
+                ++deleted;
+            total -= segment.bytes;
+        }
+        closedir(dir);
+        return deleted;
+    }
+
+    // give the extents back a step at a time, unless another link keeps the data alive
+    static void shrink(const int dir_fd, const std::string &name)
+    {
+        const int fd = openat(dir_fd, name.c_str(), O_WRONLY | O_NOFOLLOW | O_CLOEXEC);
+        if (fd < 0)
+            return;
+        struct stat st;
+        if (fstat(fd, &st) == 0 && st.st_nlink == 1)
+        {
+            for (off_t size = st.st_size; size > static_cast<off_t>(RETENTION_TRUNCATE_STEP);)
+            {
+                size -= static_cast<off_t>(RETENTION_TRUNCATE_STEP);
+                if (ftruncate(fd, size) != 0)
+                    break;
+            }
+        }
+        close(fd);
+    }
+
+    void stopWorker()
+    {
+        {
+            std::lock_guard<std::mutex> lock(_mutex);
+            _stop = true;
+        }
+        _cv.notify_all();
+        if (_worker.joinable())
+            _worker.join();
+        _stop = false;
+    }
+
+    // a pass in progress is finished first, fork() is rare enough to wait for it
+    void prepareFork() override
+    {
+        stopWorker();
+        _mutex.lock();
+    }
+
+    void parentAfterFork() override
+    {
+        if (!_pending.empty())
+            _worker = std::thread(&RetentionManager::workerLoop, this);
+        _mutex.unlock();
+    }
+
+    void childAfterFork() override
+    {
+        _pending.clear();
+        _mutex.unlock();
+    }
+
+    std::mutex _mutex;
+    std::condition_variable _cv;
+    std::condition_variable _done_cv;
+    std::deque<std::pair<std::string, RetentionPolicy>> _pending;
+    std::thread _worker;
+    bool _stop{false};
+    bool _busy{false};
+    std::atomic<std::size_t> _deleted{0};
+};
+
+} // namespace zerg
+
+#endif // RETENTION_HPP
@@ -0,0 +1,323 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SHARDED_LOGGER_HPP
+#define SHARDED_LOGGER_HPP
+
+#include "logger.hpp" // Logger
+
+#include <algorithm>     // std::sort, std::max
+#include <atomic>        // std::atomic
+#include <cstdint>       // std::uint64_t
+#include <cstdlib>       // std::strtoul
+#include <cstring>       // std::strerror
+#include <fstream>       // std::ifstream
+#include <memory>        // std::unique_ptr
+#include <mutex>         // std::mutex, std::lock_guard
+#include <string>        // std::string, std::getline
+#include <sstream>       // std::istringstream
+#include <stdexcept>     // std::runtime_error
+#include <thread>        // std::thread, std::this_thread::get_id
+#include <unordered_map> // std::unordered_map
+#include <utility>       // std::pair
+#include <vector>        // std::vector
+#include <dirent.h>      // opendir, readdir
+#include <pthread.h>     // pthread_setaffinity_np
+#include <sched.h>       // sched_getcpu, cpu_set_t
+
+namespace zerg
+{
+
+// parse a sysfs cpu list such as "0-3,8-11,16"
+inline std::vector<int> parseCpuList(const std::string &list)
+{
+    std::vector<int> cpus;
+    std::istringstream stream(list);
+    std::string range;
+    while (std::getline(stream, range, ','))
+    {
+        if (range.empty() || range == "\n")
+            continue;
+        const auto dash = range.find('-');
+        const char *text = range.c_str();
+        const int first = static_cast<int>(std::strtoul(text, nullptr, 10));
+        const int last = dash == std::string::npos
+                             ? first
+                             : static_cast<int>(std::strtoul(text + dash + 1, nullptr, 10));
+        for (int cpu = first; cpu <= last; ++cpu)
+            cpus.push_back(cpu);
+    }
+    return cpus;
+}
+
+// NUMA nodes that have cpus, read from sysfs
+struct NumaTopology
+{
+    struct Node
+    {
+        int id;
+        std::vector<int> cpus;
+    };
+    std::vector<Node> nodes;
+    std::vector<int> cpu_to_shard; // index by cpu number, -1 for unknown cpus
+
+    static NumaTopology detect(const std::string &root = "/sys/devices/system/node")
+    {
+        NumaTopology topology;
+        if (DIR *dir = ::opendir(root.c_str()))
+        {
+            while (const dirent *ent = ::readdir(dir))
+            {
+                const std::string name = ent->d_name;
+                if (name.rfind("node", 0) != 0 || name.size() == 4 ||
+                    name.find_first_not_of("0123456789", 4) != std::string::npos)
+                    continue;
+                std::ifstream cpulist(root + "/" + name + "/cpulist");
+                std::string list;
+                std::getline(cpulist, list);
+                auto cpus = parseCpuList(list);
+                if (!cpus.empty()) // memory only nodes get no shard
+                    topology.nodes.push_back({std::stoi(name.substr(4)), std::move(cpus)});
+            }
+            ::closedir(dir);
+        }
+        if (topology.nodes.empty())
+        {
+            // no sysfs: one node with every cpu
+            Node node{0, {}};
+            for (unsigned cpu = 0; cpu < std::max(1U, std::thread::hardware_concurrency()); ++cpu)
+                node.cpus.push_back(static_cast<int>(cpu));
+            topology.nodes.push_back(std::move(node));
+        }
+        std::sort(topology.nodes.begin(), topology.nodes.end(),
+                  [](const Node &a, const Node &b) { return a.id < b.id; });
+        for (std::size_t shard = 0; shard < topology.nodes.size(); ++shard)
+        {
+            for (const int cpu : topology.nodes[shard].cpus)
+            {
+                if (static_cast<std::size_t>(cpu) >= topology.cpu_to_shard.size())
+                    topology.cpu_to_shard.resize(static_cast<std::size_t>(cpu) + 1, -1);
+                topology.cpu_to_shard[static_cast<std::size_t>(cpu)] = static_cast<int>(shard);
+            }
+        }
+        return topology;
+    }
+};
+
+/*
+ * One Logger (queue + backend thread) per NUMA node
+ * Every shard is constructed on a thread bound to its node, so the queue pages are first
+ * touched there and the backend thread inherits the node's cpu mask. Producers log into the
+ * shard of the cpu they run on (sched_getcpu, a vDSO call), so queue cache lines only move
+ * within a socket. Each shard writes its own file, "<filename>.node<N>"; records are stamped
+ * on the producer with microsecond timestamps, so zerg-merge can merge the files afterwards.
+ * Throws std::runtime_error if a node's cpus cannot be bound to.
+ */
+template <std::size_t MaxFileSize, std::size_t BufferSize = MAX_FILE_SIZE> class ShardedLogger
+{
+  public:
+    using Shard = Logger<MaxFileSize, BufferSize>;
+
+    explicit ShardedLogger(const std::string &filename,
+                           const Verbosity logLevel = Verbosity::DEBUG_LVL,
+                           NumaTopology topology = NumaTopology::detect())
+        : _topology(std::move(topology)), _shards(_topology.nodes.size())
+    {
+        for (std::size_t i = 0; i < _shards.size(); ++i)
+        {
+            const auto &node = _topology.nodes[i];
+            int error = 0;
+            std::thread builder([&, i] {
+                cpu_set_t set;
+                CPU_ZERO(&set);
+                for (const int cpu : node.cpus)
+                    CPU_SET(cpu, &set);
+                // a shard built off its node would have its queue and backend thread there
+                error = pthread_setaffinity_np(pthread_self(), sizeof(set), &set);
+                if (error != 0)
+                    return;
+                _shards[i] = std::make_unique<Shard>(
+                    filename + ".node" + std::to_string(node.id), logLevel);
+                // stamped on the producer, so zerg-merge can interleave the node files
+                _shards[i]->setFineTimestamps(true);
+            });
+            builder.join();
+            if (error != 0)
+            {
+                throw std::runtime_error("Cannot bind to NUMA node " + std::to_string(node.id) +
+                                         ": " + std::strerror(error));
+            }
+        }
+    }
+
+    template <typename... Args>
+    void log(Verbosity level, const char *file, int line, const char *format, Args &&...args)
+    {
+        localShard().log(level, file, line, format, std::forward<Args>(args)...);
+    }
+
+    void setLogLevel(const Verbosity level)
+    {
+        for (auto &shard : _shards)
+            shard->setLogLevel(level);
+    }
+
+    void sync()
+    {
+        for (auto &shard : _shards)
+            shard->sync();
+    }
+
+    [[nodiscard]] std::size_t droppedCount() const
+    {
+        std::size_t dropped = 0;
+        for (const auto &shard : _shards)
+            dropped += shard->droppedCount();
+        return dropped;
+    }
+
+    [[nodiscard]] std::size_t shardCount() const { return _shards.size(); }
+    Shard &shard(const std::size_t index) { return *_shards[index]; }
+    [[nodiscard]] const NumaTopology &topology() const { return _topology; }
+
+    Shard &localShard()
+    {
+        const int cpu = sched_getcpu();
+        if (likely(cpu >= 0 && static_cast<std::size_t>(cpu) < _topology.cpu_to_shard.size()))
+        {
+            const int shard = _topology.cpu_to_shard[static_cast<std::size_t>(cpu)];
+            if (likely(shard >= 0))
+                return *_shards[static_cast<std::size_t>(shard)];
+        }
+        return *_shards.front();
+    }
+
+  private:
+    NumaTopology _topology;
+    std::vector<std::unique_ptr<Shard>> _shards;
+};
+
+/*
+ * One Logger per producing thread, each writing "<filename>.t<N>"
+ * A thread gets its shard on its first call, after that log() touches nothing another
+ * producer writes: its own queue, its own backend, its own file. Shards stamp records on
+ * the producer with microsecond timestamps, so zerg-merge can k-way merge the files into
+ * one ordered stream when someone needs to read them. Pass a BackendPool to drain the
+ * shards with a few shared workers instead of one backend thread per producer.
+ */
+template <std::size_t MaxFileSize, std::size_t BufferSize = MAX_FILE_SIZE> class PerThreadLogger
+{
+  public:
+    using Shard = Logger<MaxFileSize, BufferSize>;
+
+    explicit PerThreadLogger(std::string filename, const Verbosity logLevel = Verbosity::DEBUG_LVL,
+                             BackendPool *pool = nullptr)
+        : _filename(std::move(filename)), _log_level(logLevel), _pool(pool), _id(nextId())
+    {
+    }
+
+    template <typename... Args>
+    void log(Verbosity level, const char *file, int line, const char *format, Args &&...args)
+    {
+        localShard().log(level, file, line, format, std::forward<Args>(args)...);
+    }
+
+    void setLogLevel(const Verbosity level)
+    {
+        std::lock_guard<std::mutex> lock(_shards_mutex);
+        _log_level = level;
+        for (auto &shard : _shards)
+            shard->setLogLevel(level);
+    }
+
+    void sync()
+    {
+        std::lock_guard<std::mutex> lock(_shards_mutex);
+        for (auto &shard : _shards)
+            shard->sync();
+    }
+
+    [[nodiscard]] std::size_t droppedCount() const
+    {
+        std::lock_guard<std::mutex> lock(_shards_mutex);
+        std::size_t dropped = 0;
+        for (const auto &shard : _shards)
+            dropped += shard->droppedCount();
+        return dropped;
+    }
+
+    [[nodiscard]] std::size_t shardCount() const
+    {
+        std::lock_guard<std::mutex> lock(_shards_mutex);
+        return _shards.size();
+    }
+
+    Shard &localShard()
+    {
+        // keyed by instance id rather than address, a new logger may reuse a freed address
+        thread_local std::vector<std::pair<std::uint64_t, Shard *>> cache;
+        for (const auto &[id, shard] : cache)
+        {
+            if (likely(id == _id))
+                return *shard;
+        }
+        // entries of destroyed loggers pile up otherwise; an evicted live one is found
+        // again by shardOf, never created twice
+        if (cache.size() >= 16)
+            cache.erase(cache.begin());
+        Shard *shard = shardOf(std::this_thread::get_id());
+        cache.emplace_back(_id, shard);
+        return *shard;
+    }
+
+  private:
+    // The thread's shard, created on its first call. A thread id reused after its thread
+    // exited gets that thread's shard, still one producer per shard
+    Shard *shardOf(const std::thread::id thread)
+    {
+        std::lock_guard<std::mutex> lock(_shards_mutex);
+        if (const auto it = _thread_shards.find(thread); it != _thread_shards.end())
+            return it->second;
+        auto shard = std::make_unique<Shard>(_filename + ".t" + std::to_string(_shards.size()),
+                                             _log_level, nullptr, _pool);
+        shard->setFineTimestamps(true);
+        _shards.push_back(std::move(shard));
+        _thread_shards.emplace(thread, _shards.back().get());
+        return _shards.back().get();
+    }
+
+    static std::uint64_t nextId()
+    {
+        static std::atomic<std::uint64_t> next{1};
+        return next.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::string _filename;
+    Verbosity _log_level; // guarded by _shards_mutex
+    BackendPool *_pool;
+    const std::uint64_t _id;
+    mutable std::mutex _shards_mutex;
+    std::vector<std::unique_ptr<Shard>> _shards;
+    std::unordered_map<std::thread::id, Shard *> _thread_shards; // guarded by _shards_mutex
+};
+
+} // namespace zerg
+
+#endif // SHARDED_LOGGER_HPP
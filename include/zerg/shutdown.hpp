@@ -0,0 +1,142 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef SHUTDOWN_HPP
+#define SHUTDOWN_HPP
+
+#include <algorithm> // std::min, std::remove
+#include <atomic>    // std::atomic
+#include <chrono>    // std::chrono::steady_clock, std::chrono::milliseconds
+#include <cstddef>   // std::size_t
+#include <mutex>     // std::mutex, std::lock_guard
+#include <thread>    // std::thread
+#include <vector>    // std::vector
+
+namespace zerg
+{
+
+// what one logger could not get done by the deadline
+struct DrainResult
+{
+    std::size_t unwritten{}; // records still queued or cut off in the backend's batch
+    std::size_t dropped{};   // records rejected earlier because the queue was full
+};
+
+// Implemented by Logger: stop the backend, write out the queue on the calling thread until
+// it is empty or the deadline passes, flush
+class Drainable
+{
+  public:
+    virtual ~Drainable() = default;
+    virtual DrainResult drainBy(std::chrono::steady_clock::time_point deadline) = 0;
+};
+
+struct ShutdownReport
+{
+    std::size_t loggers{};   // loggers drained
+    std::size_t unwritten{}; // records left queued when the deadline passed, summed
+    std::size_t dropped{};   // records rejected on full queues over the process lifetime
+    bool timed_out{};
+    std::chrono::milliseconds elapsed{};
+};
+
+// every live logger, so shutdown() can reach them regardless of static destruction order
+class DrainRegistry
+{
+  public:
+    static DrainRegistry &instance()
+    {
+        // never destroyed, as ForkRegistry: ~Logger of the global loggers runs after it
+        static DrainRegistry *registry = new DrainRegistry;
+        return *registry;
+    }
+
+    void add(Drainable *logger)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _loggers.push_back(logger);
+    }
+
+    void remove(Drainable *logger)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _loggers.erase(std::remove(_loggers.begin(), _loggers.end(), logger), _loggers.end());
+    }
+
+    // loggers stay registered (and alive: destructors wait on the lock) until fn returns
+    template <typename Fn> void forAll(Fn &&fn)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        fn(_loggers);
+    }
+
+  private:
+    std::mutex _mutex;
+    std::vector<Drainable *> _loggers;
+};
+
+/*
+ * Drain every logger in parallel, flush and stop their backend threads, giving up on what
+ * is left at the deadline. A backend thread busy with a batch stops after the chunk it is
+ * writing (WRITE_CHUNK_RECORDS), the rest of that batch counts as unwritten. Meant for the
+ * end of main(): afterwards the logger destructors only have records logged after this
+ * call, or left unwritten by it, to write, and none of them waits for sync()'s quiet period.
+ * A logger keeps accepting records after shutdown, they are written when it is destroyed.
+ */
+inline ShutdownReport
+shutdown(const std::chrono::milliseconds deadline = std::chrono::milliseconds(500))
+{
+    const auto start = std::chrono::steady_clock::now();
+    const auto until = start + deadline;
+    ShutdownReport report;
+
+    DrainRegistry::instance().forAll([&](const std::vector<Drainable *> &loggers) {
+        report.loggers = loggers.size();
+        std::vector<DrainResult> results(loggers.size());
+        std::atomic<std::size_t> next{0};
+        auto drainSome = [&] {
+            for (std::size_t i = next.fetch_add(1); i < loggers.size(); i = next.fetch_add(1))
+                results[i] = loggers[i]->drainBy(until);
+        };
+        const std::size_t cores = std::max(1u, std::thread::hardware_concurrency());
+        const std::size_t threads = std::min(loggers.size(), cores);
+        std::vector<std::thread> workers;
+        for (std::size_t t = 1; t < threads; ++t)
+            workers.emplace_back(drainSome);
+        drainSome();
+        for (auto &worker : workers)
+            worker.join();
+
+        for (const auto &result : results)
+        {
+            report.unwritten += result.unwritten;
+            report.dropped += result.dropped;
+        }
+    });
+
+    report.timed_out = report.unwritten > 0;
+    report.elapsed = std::chrono::duration_cast<std::chrono::milliseconds>(
+        std::chrono::steady_clock::now() - start);
+    return report;
+}
+
+} // namespace zerg
+
+#endif // SHUTDOWN_HPP
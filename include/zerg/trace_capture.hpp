@@ -0,0 +1,362 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TRACE_CAPTURE_HPP
+#define TRACE_CAPTURE_HPP
+
+#include "verbosity.hpp" // Verbosity
+
+#include <algorithm>     // std::max
+#include <chrono>        // std::chrono::steady_clock
+#include <cstdint>       // std::uint8_t, std::uint32_t, std::uint64_t
+#include <cstring>       // std::strlen
+#include <fstream>       // std::ofstream, std::ifstream
+#include <iterator>      // std::istreambuf_iterator
+#include <mutex>         // std::mutex, std::lock_guard
+#include <stdexcept>     // std::runtime_error
+#include <string>        // std::string
+#include <string_view>   // std::string_view
+#include <thread>        // std::thread::id
+#include <type_traits>   // std::decay_t, std::is_*
+#include <unordered_map> // std::unordered_map
+#include <vector>        // std::vector
+#include <fmt/format.h>  // fmt::formatted_size
+
+namespace zerg
+{
+
+/*
+ * Workload capture
+ * A TraceRecorder attached to a Logger (@Logger::setTraceRecorder) records every accepted
+ * log call as a compact binary trace: callsite, level, producing thread, inter-arrival time
+ * and the type and size of each argument, never the argument values.
+ * readTrace() loads a trace back for replay (see benchmark/replay_benchmark.cpp).
+ *
+ * Format: "ZTRC" + version byte, then tagged entries with LEB128 varints
+ *   CALLSITE: tag, id, line, file, format          (once per distinct callsite)
+ *   RECORD:   tag, callsite, level, thread, zigzag delta ns, arg count, {type, size}...
+ */
+
+enum class TraceArgType : std::uint8_t
+{
+    BOOL,
+    CHAR,
+    INT,
+    UINT,
+    FLOAT,
+    C_STR,
+    STRING,
+    POINTER,
+    OTHER
+};
+
+struct TraceArg
+{
+    TraceArgType type{};
+    std::uint32_t size{}; // sizeof for scalars, length for strings, formatted size otherwise
+};
+
+template <typename T> TraceArg traceArg(const T &value)
+{
+    using D = std::decay_t<T>;
+    if constexpr (std::is_same_v<D, bool>)
+        return {TraceArgType::BOOL, sizeof(bool)};
+    else if constexpr (std::is_same_v<D, char>)
+        return {TraceArgType::CHAR, sizeof(char)};
+    else if constexpr (std::is_integral_v<D> && std::is_signed_v<D>)
+        return {TraceArgType::INT, sizeof(D)};
+    else if constexpr (std::is_integral_v<D>)
+        return {TraceArgType::UINT, sizeof(D)};
+    else if constexpr (std::is_floating_point_v<D>)
+        return {TraceArgType::FLOAT, sizeof(D)};
+    else if constexpr (std::is_same_v<D, const char *> || std::is_same_v<D, char *>)
+        return {TraceArgType::C_STR, static_cast<std::uint32_t>(std::strlen(value))};
+    else if constexpr (std::is_convertible_v<const T &, std::string_view>)
+        return {TraceArgType::STRING,
+                static_cast<std::uint32_t>(std::string_view(value).size())};
+    else if constexpr (std::is_pointer_v<D>)
+        return {TraceArgType::POINTER, sizeof(D)};
+    else
+        return {TraceArgType::OTHER,
+                static_cast<std::uint32_t>(fmt::formatted_size("{}", value))};
+}
+
+namespace trace_detail
+{
+constexpr char MAGIC[4] = {'Z', 'T', 'R', 'C'};
+constexpr std::uint8_t VERSION = 1;
+constexpr std::uint8_t TAG_CALLSITE = 1;
+constexpr std::uint8_t TAG_RECORD = 2;
+constexpr std::size_t FLUSH_THRESHOLD = 64 * 1024;
+constexpr unsigned VARINT_BITS = 7;
+constexpr std::uint8_t VARINT_MORE = 0x80;
+constexpr std::uint8_t VARINT_MASK = 0x7f;
+
+inline void putVarint(std::string &out, std::uint64_t value)
+{
+    while (value >= VARINT_MORE)
+    {
+        out.push_back(static_cast<char>((value & VARINT_MASK) | VARINT_MORE));
+        value >>= VARINT_BITS;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+inline std::uint64_t zigzag(const std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+inline std::int64_t unzigzag(const std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+} // namespace trace_detail
+
+class TraceRecorder
+{
+  public:
+    explicit TraceRecorder(const std::string &path)
+        : _out(path, std::ios::out | std::ios::binary | std::ios::trunc)
+    {
+        if (!_out.is_open())
+        {
+            throw std::runtime_error("Could not open trace file " + path);
+        }
+        _buffer.append(trace_detail::MAGIC, sizeof(trace_detail::MAGIC));
+        _buffer.push_back(static_cast<char>(trace_detail::VERSION));
+    }
+
+    ~TraceRecorder() { flush(); }
+
+    TraceRecorder(const TraceRecorder &) = delete;
+    TraceRecorder &operator=(const TraceRecorder &) = delete;
+
+    template <typename... Args>
+    void record(Verbosity level, const char *file, int line, const char *format,
+                const Args &...args)
+    {
+        const auto now = std::chrono::steady_clock::now();
+        const TraceArg types[] = {TraceArg{}, traceArg(args)...};
+        append(now, level, file, line, format, types + 1, sizeof...(Args));
+    }
+
+    void flush()
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        flushLocked();
+    }
+
+    [[nodiscard]] std::uint64_t recorded() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _records;
+    }
+
+  private:
+    void append(const std::chrono::steady_clock::time_point now, Verbosity level,
+                const char *file, int line, const char *format, const TraceArg *args,
+                std::size_t count)
+    {
+        using namespace trace_detail;
+        std::lock_guard<std::mutex> lock(_mutex);
+
+        // formats passed as std::string::c_str() can reuse an address, so key on contents
+        _key.assign(file).append(":").append(std::to_string(line)).push_back('\0');
+        _key.append(format);
+        auto [site, inserted] =
+            _callsites.try_emplace(_key, static_cast<std::uint32_t>(_callsites.size()));
+        if (inserted)
+        {
+            _buffer.push_back(static_cast<char>(TAG_CALLSITE));
+            putVarint(_buffer, site->second);
+            putVarint(_buffer, static_cast<std::uint64_t>(line));
+            putString(file);
+            putString(format);
+        }
+
+        auto [thread, new_thread] = _threads.try_emplace(
+            std::this_thread::get_id(), static_cast<std::uint32_t>(_threads.size()));
+        (void)new_thread;
+
+        const auto ns = std::chrono::duration_cast<std::chrono::nanoseconds>(
+                            now.time_since_epoch())
+                            .count();
+        const std::int64_t delta = _records == 0 ? 0 : ns - _last_ns;
+        _last_ns = ns;
+
+        _buffer.push_back(static_cast<char>(TAG_RECORD));
+        putVarint(_buffer, site->second);
+        _buffer.push_back(static_cast<char>(level));
+        putVarint(_buffer, thread->second);
+        putVarint(_buffer, zigzag(delta));
+        putVarint(_buffer, count);
+        for (std::size_t i = 0; i < count; ++i)
+        {
+            _buffer.push_back(static_cast<char>(args[i].type));
+            putVarint(_buffer, args[i].size);
+        }
+        ++_records;
+
+        if (_buffer.size() >= FLUSH_THRESHOLD)
+            flushLocked();
+    }
+
+    void putString(const char *str)
+    {
+        const std::size_t len = std::strlen(str);
+        trace_detail::putVarint(_buffer, len);
+        _buffer.append(str, len);
+    }
+
+    void flushLocked()
+    {
+        _out.write(_buffer.data(), static_cast<std::streamsize>(_buffer.size()));
+        _out.flush();
+        _buffer.clear();
+    }
+
+    mutable std::mutex _mutex;
+    std::ofstream _out;
+    std::string _buffer;
+    std::string _key;
+    std::unordered_map<std::string, std::uint32_t> _callsites;
+    std::unordered_map<std::thread::id, std::uint32_t> _threads;
+    std::int64_t _last_ns{};
+    std::uint64_t _records{};
+};
+
+struct TraceCallsite
+{
+    std::string file;
+    int line{};
+    std::string format;
+};
+
+struct TraceEvent
+{
+    std::uint32_t callsite{};
+    Verbosity level{};
+    std::uint32_t thread{};
+    std::int64_t time_ns{}; // relative to the first record
+    std::vector<TraceArg> args;
+};
+
+struct Trace
+{
+    std::vector<TraceCallsite> callsites;
+    std::vector<TraceEvent> events;
+    std::uint32_t threads{};
+};
+
+inline Trace readTrace(const std::string &path)
+{
+    using namespace trace_detail;
+    std::ifstream in(path, std::ios::binary);
+    if (!in.is_open())
+    {
+        throw std::runtime_error("Could not open trace file " + path);
+    }
+    const std::string data((std::istreambuf_iterator<char>(in)),
+                           std::istreambuf_iterator<char>());
+    std::size_t pos = 0;
+
+    auto fail = [&path]() -> void { throw std::runtime_error("Corrupt trace file " + path); };
+    auto byte = [&]() -> std::uint8_t {
+        if (pos >= data.size())
+            fail();
+        return static_cast<std::uint8_t>(data[pos++]);
+    };
+    auto varint = [&]() -> std::uint64_t {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += VARINT_BITS)
+        {
+            const std::uint8_t b = byte();
+            value |= static_cast<std::uint64_t>(b & VARINT_MASK) << shift;
+            if ((b & VARINT_MORE) == 0)
+                return value;
+        }
+        fail();
+        return 0;
+    };
+    auto string = [&]() -> std::string {
+        const auto len = varint();
+        if (len > data.size() - pos)
+            fail();
+        std::string str = data.substr(pos, len);
+        pos += len;
+        return str;
+    };
+
+    if (data.size() < sizeof(MAGIC) + 1 ||
+        data.compare(0, sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0)
+        fail();
+    pos = sizeof(MAGIC);
+    if (byte() != VERSION)
+        throw std::runtime_error("Unsupported trace version in " + path);
+
+    Trace trace;
+    std::int64_t time_ns = 0;
+    while (pos < data.size())
+    {
+        const std::uint8_t tag = byte();
+        if (tag == TAG_CALLSITE)
+        {
+            const auto id = varint();
+            if (id != trace.callsites.size())
+                fail();
+            TraceCallsite site;
+            site.line = static_cast<int>(varint());
+            site.file = string();
+            site.format = string();
+            trace.callsites.push_back(std::move(site));
+        }
+        else if (tag == TAG_RECORD)
+        {
+            TraceEvent event;
+            event.callsite = static_cast<std::uint32_t>(varint());
+            event.level = static_cast<Verbosity>(byte());
+            event.thread = static_cast<std::uint32_t>(varint());
+            time_ns += unzigzag(varint());
+            event.time_ns = time_ns;
+            const auto count = varint();
+            for (std::uint64_t i = 0; i < count; ++i)
+            {
+                TraceArg arg;
+                arg.type = static_cast<TraceArgType>(byte());
+                arg.size = static_cast<std::uint32_t>(varint());
+                event.args.push_back(arg);
+            }
+            if (event.callsite >= trace.callsites.size())
+                fail();
+            trace.threads = std::max(trace.threads, event.thread + 1);
+            trace.events.push_back(std::move(event));
+        }
+        else
+        {
+            fail();
+        }
+    }
+    return trace;
+}
+
+} // namespace zerg
+
+#endif // TRACE_CAPTURE_HPP
@@ -0,0 +1,103 @@
+// Copyright 2025 Joseph A. Loftus
+//
+// Permission is hereby granted, free of charge, to any person obtaining a copy
+// of this software and associated documentation files (the "Software"), to deal
+// in the Software without restriction, including without limitation the rights
+// to use, copy, modify, merge, publish, distribute, sublicense, and/or sell
+// copies of the Software, and to permit persons to whom the Software is
+// furnished to do so, subject to the following conditions:
+//
+// The above copyright notice and this permission notice shall be included in all
+// copies or substantial portions of the Software.
+//
+// THE SOFTWARE IS PROVIDED "AS IS", WITHOUT WARRANTY OF ANY KIND, EXPRESS OR
+// IMPLIED, INCLUDING BUT NOT LIMITED TO THE WARRANTIES OF MERCHANTABILITY,
+// FITNESS FOR A PARTICULAR PURPOSE AND NONINFRINGEMENT. IN NO EVENT SHALL THE
+// AUTHORS OR COPYRIGHT HOLDERS BE LIABLE FOR ANY CLAIM, DAMAGES OR OTHER
+// LIABILITY, WHETHER IN AN ACTION OF CONTRACT, TORT OR OTHERWISE, ARISING FROM,
+// OUT OF OR IN CONNECTION WITH THE SOFTWARE OR THE USE OR OTHER DEALINGS IN THE
+// SOFTWARE.
+
+#ifndef TSC_CLOCK_HPP
+#define TSC_CLOCK_HPP
+
+#include <cstdint> // std::uint64_t, std::int64_t
+#include <thread>  // std::this_thread::sleep_for
+#include <chrono>  // std::chrono::milliseconds
+#include <time.h>  // clock_gettime, timespec
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <x86intrin.h> // __rdtsc
+#endif
+
+namespace zerg
+{
+
+/*
+ * Timestamp counter clock for producer side timestamps without a syscall or vDSO call.
+ * now() is a raw rdtsc read; converting ticks to wall clock time is left to the backend.
+ * The tick rate is calibrated once against CLOCK_REALTIME, which assumes an invariant TSC
+ * (constant_tsc / nonstop_tsc in /proc/cpuinfo, true for any recent x86 server).
+ * Other architectures fall back to CLOCK_MONOTONIC nanoseconds.
+ */
+class TscClock
+{
+  public:
+    // calibrates on first use (~10 ms), call it before the latency sensitive path starts
+    static const TscClock &instance()
+    {
+        static const TscClock clock;
+        return clock;
+    }
+
+    static std::uint64_t now()
+    {
+#if defined(__x86_64__) || defined(__i386__)
+        return __rdtsc();
+#else
+        struct timespec ts;
+        clock_gettime(CLOCK_MONOTONIC, &ts);
+        return static_cast<std::uint64_t>(ts.tv_sec) * 1000000000ULL +
+               static_cast<std::uint64_t>(ts.tv_nsec);
+#endif
+    }
+
+    // nanoseconds since the epoch for a value returned by now()
+    [[nodiscard]] std::int64_t toRealtimeNs(const std::uint64_t ticks) const
+    {
+        const double delta = static_cast<double>(static_cast<std::int64_t>(ticks - _base_ticks));
+        return _base_realtime_ns + static_cast<std::int64_t>(delta * _ns_per_tick);
+    }
+
+    [[nodiscard]] double nsPerTick() const { return _ns_per_tick; }
+
+  private:
+    TscClock()
+    {
+        const std::int64_t realtime_start = realtimeNs();
+        const std::uint64_t ticks_start = now();
+        std::this_thread::sleep_for(std::chrono::milliseconds(10));
+        const std::int64_t realtime_end = realtimeNs();
+        const std::uint64_t ticks_end = now();
+
+        _ns_per_tick = static_cast<double>(realtime_end - realtime_start) /
+                       static_cast<double>(ticks_end - ticks_start);
+        _base_ticks = ticks_end;
+        _base_realtime_ns = realtime_end;
+    }
+
+    static std::int64_t realtimeNs()
+    {
+        struct timespec ts;
+        clock_gettime(CLOCK_REALTIME, &ts);
+        return static_cast<std::int64_t>(ts.tv_sec) * 1000000000LL + ts.tv_nsec;
+    }
+
+    std::uint64_t _base_ticks{};
+    std::int64_t _base_realtime_ns{};
+    double _ns_per_tick{1.0};
+};
+
+} // namespace zerg
+
+#endif // TSC_CLOCK_HPP
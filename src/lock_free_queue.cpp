@@ -1,60 +1,372 @@
-#include "../include/zerg/lock_free_queue.hpp"
+#include "../include/zerg/mpmc_queue.hpp"
 #include <pthread.h>
-#include <vector>
+#include <sched.h>
+#include <unistd.h>
+#include <algorithm>
+#include <array>
+#include <atomic>
 #include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <deque>
+#include <mutex>
+#include <thread>
+#include <vector>
+
+// Queue benchmark for LockFreeQueue
+//
+// 1. Ping-pong round trip latency between every pair of cores (SPSC, one item in flight)
+// 2. Sustained throughput for SPSC / MPSC / MPMC with payloads from 8 B to 256 B
+// Both are compared against a bounded std::mutex + std::deque baseline.
+//
+// usage: queue_benchmark [--cpus 0,2,4] [--latency-iters N] [--items N] [--no-latency]
+//                        [--no-throughput]
+// Pairs that are SMT siblings or live on different sockets show up as distinct
+// bands in the latency matrix, pin the cpu list to what you want to compare.
+
+namespace
+{
+
+inline void cpuRelax() { __asm__ volatile("pause" ::: "memory"); }
+
+// bounded mutex + deque with the same interface as LockFreeQueue
+template <typename T> class MutexQueue
+{
+  public:
+    explicit MutexQueue(const size_t capacity) : _capacity(capacity) {}
+
+    [[nodiscard]] bool enqueue(const T &item)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_items.size() >= _capacity - 1)
+            return false;
+        _items.push_back(item);
+        return true;
+    }
+
+    [[nodiscard]] bool dequeue(T &item)
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        if (_items.empty())
+            return false;
+        item = _items.front();
+        _items.pop_front();
+        return true;
+    }
+
+  private:
+    const size_t _capacity;
+    std::mutex _mutex;
+    std::deque<T> _items;
+};
+
+template <size_t N> struct Payload
+{
+    std::array<char, N> data{};
+};
+
+using Clock = std::chrono::steady_clock;
+
+void pinThread(const int cpu)
+{
+    if (cpu < 0)
+        return;
+    cpu_set_t cpus;
+    CPU_ZERO(&cpus);
+    CPU_SET(cpu, &cpus);
+    if (::pthread_setaffinity_np(::pthread_self(), sizeof(cpus), &cpus) != 0)
+    {
+        std::fprintf(stderr, "failed to pin thread to cpu %d\n", cpu);
+        std::abort();
+    }
+}
+
+std::vector<int> allowedCpus()
+{
+    std::vector<int> cpus;
+    cpu_set_t set;
+    CPU_ZERO(&set);
+    if (::sched_getaffinity(0, sizeof(set), &set) == 0)
+    {
+        for (int cpu = 0; cpu < CPU_SETSIZE; ++cpu)
+        {
+            if (CPU_ISSET(cpu, &set))
+                cpus.push_back(cpu);
+        }
+    }
+    return cpus;
+}
 
-static void *producer_thread(void *arg)
+std::vector<int> parseCpuList(const char *list)
 {
-    auto *queue = static_cast<LockFreeQueue<int> *>(arg);
-    for (int i = 0; i < 100; ++i)
+    std::vector<int> cpus;
+    const char *p = list;
+    while (*p != '\0')
     {
-        while (!queue->enqueue(i))
+        char *end = nullptr;
+        const long cpu = std::strtol(p, &end, 10);
+        if (end == p)
         {
-            __asm__ volatile("pause" ::: "memory");
+            std::fprintf(stderr, "invalid cpu list: %s\n", list);
+            std::exit(1);
         }
+        cpus.push_back(static_cast<int>(cpu));
+        p = (*end == ',') ? end + 1 : end;
     }
-    return nullptr;
+    return cpus;
 }
 
-static void *consumer_thread(void *arg)
+// start gate so every thread begins after all of them are pinned, the owner
+// takes its start timestamp between waitReady() and open()
+class StartGate
 {
-    auto *queue = static_cast<LockFreeQueue<int> *>(arg);
-    int value;
-    int count = 0;
+  public:
+    explicit StartGate(const size_t count) : _count(count) {}
 
-    while (count < 100)
+    void arriveAndWait()
     {
-        if (queue->dequeue(value))
+        _arrived.fetch_add(1, std::memory_order_acq_rel);
+        while (!_open.load(std::memory_order_acquire))
+            cpuRelax();
+    }
+
+    void waitReady() const
+    {
+        while (_arrived.load(std::memory_order_acquire) < _count)
+            std::this_thread::yield();
+    }
+
+    void open() { _open.store(true, std::memory_order_release); }
+
+  private:
+    const size_t _count;
+    std::atomic<size_t> _arrived{0};
+    std::atomic<bool> _open{false};
+};
+
+/*
+ * Ping-pong latency
+ * the initiator sends a value over "ping" and spins until the echo comes back on "pong",
+ * so each iteration is one full cache line round trip in each direction.
+ */
+template <template <typename> class Queue>
+double pingPongNs(const int cpu_a, const int cpu_b, const size_t iterations)
+{
+    Queue<uint64_t> ping(2);
+    Queue<uint64_t> pong(2);
+    StartGate gate(1);
+
+    std::thread echo([&] {
+        pinThread(cpu_b);
+        gate.arriveAndWait();
+        uint64_t value = 0;
+        for (size_t i = 0; i < iterations; ++i)
         {
-            count++;
+            while (!ping.dequeue(value))
+                cpuRelax();
+            while (!pong.enqueue(value))
+                cpuRelax();
         }
-        else
+    });
+
+    pinThread(cpu_a);
+    gate.waitReady();
+    gate.open();
+    const auto start = Clock::now();
+    uint64_t value = 0;
+    for (size_t i = 0; i < iterations; ++i)
+    {
+        while (!ping.enqueue(i))
+            cpuRelax();
+        while (!pong.dequeue(value))
+            cpuRelax();
+    }
+    const auto elapsed = Clock::now() - start;
+    echo.join();
+
+    return static_cast<double>(
+               std::chrono::duration_cast<std::chrono::nanoseconds>(elapsed).count()) /
+           static_cast<double>(iterations);
+}
+
+template <template <typename> class Queue>
+void printLatencyMatrix(const char *name, const std::vector<int> &cpus, const size_t iterations)
+{
+    std::printf("\n%s round trip latency (ns), row = initiator, column = echo\n", name);
+    std::printf("%6s", "");
+    for (const int cpu : cpus)
+        std::printf("%8d", cpu);
+    std::printf("\n");
+
+    for (const int a : cpus)
+    {
+        std::printf("%6d", a);
+        for (const int b : cpus)
         {
-            __asm__ volatile("pause" ::: "memory");
+            if (a == b)
+            {
+                std::printf("%8s", "-");
+                continue;
+            }
+            std::printf("%8.0f", pingPongNs<Queue>(a, b, iterations));
+            std::fflush(stdout);
         }
+        std::printf("\n");
     }
-    return nullptr;
 }
 
-int main()
+/*
+ * Throughput
+ * every producer pushes a fixed number of items, consumers share the work until the
+ * total is reached. Returns items per second for the whole run.
+ */
+template <template <typename> class Queue, typename T>
+double throughput(const std::vector<int> &cpus, const size_t producers, const size_t consumers,
+                  const size_t items_per_producer)
 {
-    LockFreeQueue<int> queue(1024);
+    constexpr size_t capacity = 64 * 1024;
+    Queue<T> queue(capacity);
+    const size_t total = producers * items_per_producer;
+    std::atomic<size_t> consumed{0};
+    StartGate gate(producers + consumers);
+    std::vector<std::thread> threads;
 
-    constexpr int NUM_THREADS = 4;
-    std::vector<pthread_t> producers(NUM_THREADS);
-    std::vector<pthread_t> consumers(NUM_THREADS);
+    auto cpuFor = [&](const size_t i) { return cpus.empty() ? -1 : cpus[i % cpus.size()]; };
 
-    for (int i = 0; i < NUM_THREADS; ++i)
+    for (size_t p = 0; p < producers; ++p)
+    {
+        threads.emplace_back([&, p] {
+            pinThread(cpuFor(p));
+            gate.arriveAndWait();
+            T item{};
+            for (size_t i = 0; i < items_per_producer; ++i)
+            {
+                item.data[0] = static_cast<char>(i);
+                while (!queue.enqueue(item))
+                    cpuRelax();
+            }
+        });
+    }
+    for (size_t c = 0; c < consumers; ++c)
     {
-        pthread_create(&producers[i], nullptr, producer_thread, &queue);
-        pthread_create(&consumers[i], nullptr, consumer_thread, &queue);
+        threads.emplace_back([&, c] {
+            pinThread(cpuFor(producers + c));
+            gate.arriveAndWait();
+            T item{};
+            while (consumed.load(std::memory_order_relaxed) < total)
+            {
+                if (queue.dequeue(item))
+                    consumed.fetch_add(1, std::memory_order_relaxed);
+                else
+                    cpuRelax();
+            }
+        });
     }
 
-    for (int i = 0; i < NUM_THREADS; ++i)
+    gate.waitReady();
+    const auto start = Clock::now();
+    gate.open();
+    for (auto &thread : threads)
+        thread.join();
+    const auto elapsed = std::chrono::duration<double>(Clock::now() - start).count();
+    return static_cast<double>(total) / elapsed;
+}
+
+struct Config
+{
+    const char *name;
+    size_t producers;
+    size_t consumers;
+};
+
+template <size_t N>
+void printThroughputRow(const Config &config, const std::vector<int> &cpus, const size_t items)
+{
+    const double lock_free =
+        throughput<LockFreeQueue, Payload<N>>(cpus, config.producers, config.consumers, items);
+    const double baseline =
+        throughput<MutexQueue, Payload<N>>(cpus, config.producers, config.consumers, items);
+    const double mib = 1024.0 * 1024.0;
+    std::printf("%-6s %2zux%-2zu %5zu B %12.2f %10.1f %12.2f %10.1f %8.2fx\n", config.name,
+                config.producers, config.consumers, N, lock_free / 1e6,
+                lock_free * static_cast<double>(N) / mib, baseline / 1e6,
+                baseline * static_cast<double>(N) / mib, lock_free / baseline);
+    std::fflush(stdout);
+}
+
+void printThroughputTable(const std::vector<int> &cpus, const size_t items)
+{
+    const size_t threads = std::max<size_t>(2, std::min<size_t>(cpus.size() / 2, 4));
+    const std::array<Config, 3> configs{{{"SPSC", 1, 1},
+                                         {"MPSC", threads, 1},
+                                         {"MPMC", threads, threads}}};
+
+    std::printf("\nthroughput, %zu items per producer\n", items);
+    std::printf("%-6s %5s %7s %12s %10s %12s %10s %9s\n", "mode", "P x C", "payload",
+                "lf Mitems/s", "lf MiB/s", "mtx Mitems/s", "mtx MiB/s", "speedup");
+    for (const auto &config : configs)
     {
-        pthread_join(producers[i], nullptr);
-        pthread_join(consumers[i], nullptr);
+        printThroughputRow<8>(config, cpus, items);
+        printThroughputRow<16>(config, cpus, items);
+        printThroughputRow<32>(config, cpus, items);
+        printThroughputRow<64>(config, cpus, items);
+        printThroughputRow<128>(config, cpus, items);
+        printThroughputRow<256>(config, cpus, items);
+    }
+}
+
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::vector<int> cpus = allowedCpus();
+    size_t latency_iters = 100000;
+    size_t items = 1000000;
+    bool run_latency = true;
+    bool run_throughput = true;
+
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "--cpus") == 0 && i + 1 < argc)
+            cpus = parseCpuList(argv[++i]);
+        else if (std::strcmp(argv[i], "--latency-iters") == 0 && i + 1 < argc)
+            latency_iters = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--items") == 0 && i + 1 < argc)
+            items = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "--no-latency") == 0)
+            run_latency = false;
+        else if (std::strcmp(argv[i], "--no-throughput") == 0)
+            run_throughput = false;
+        else
+        {
+            std::fprintf(stderr,
+                         "usage: %s [--cpus 0,1,...] [--latency-iters N] [--items N] "
+                         "[--no-latency] [--no-throughput]\n",
+                         argv[0]);
+            return 1;
+        }
     }
 
+    std::printf("cpus:");
+    for (const int cpu : cpus)
+        std::printf(" %d", cpu);
+    std::printf("\n");
+
+    if (run_latency)
+    {
+        if (cpus.size() < 2)
+            std::printf("\nlatency matrix needs at least two cpus, skipping\n");
+        else
+        {
+            printLatencyMatrix<LockFreeQueue>("LockFreeQueue", cpus, latency_iters);
+            printLatencyMatrix<MutexQueue>("mutex + deque", cpus, latency_iters);
+        }
+    }
+
+    if (run_throughput)
+        printThroughputTable(cpus, items);
+
     return 0;
-}
\ No newline at end of file
+}
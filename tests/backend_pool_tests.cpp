@@ -0,0 +1,112 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/backend_pool.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using PooledLogger = zerg::Logger<(1ULL << 40), 1024>;
+
+class RecordingBackend : public zerg::ILogBackend
+{
+  public:
+    void write(const char *data, std::streamsize size) override
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        _lines.emplace_back(data, static_cast<std::size_t>(size));
+        _count.fetch_add(1, std::memory_order_release);
+    }
+    void writeNewline() override {}
+    void flush() override {}
+
+    bool waitFor(const std::size_t count) const
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (_count.load(std::memory_order_acquire) < count)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::yield();
+        }
+        return true;
+    }
+
+    std::vector<std::string> lines() const
+    {
+        std::lock_guard<std::mutex> lock(_mutex);
+        return _lines;
+    }
+
+  private:
+    mutable std::mutex _mutex;
+    std::vector<std::string> _lines;
+    std::atomic<std::size_t> _count{0};
+};
+} // namespace
+
+TEST(BackendPoolTest, ManyLoggersKeepPerLoggerOrder)
+{
+    constexpr int loggers = 48;
+    constexpr int records = 300;
+    zerg::BackendPool pool(3);
+
+    std::vector<RecordingBackend *> backends;
+    std::vector<std::unique_ptr<PooledLogger>> instances;
+    for (int i = 0; i < loggers; ++i)
+    {
+        auto backend = std::make_unique<RecordingBackend>();
+        backends.push_back(backend.get());
+        instances.push_back(std::make_unique<PooledLogger>(
+            "unused", zerg::Verbosity::DEBUG_LVL, std::move(backend), &pool));
+    }
+
+    // very uneven activity: logger i writes i * records / loggers + 1 records
+    std::vector<std::thread> producers;
+    for (int i = 0; i < loggers; ++i)
+    {
+        producers.emplace_back([&, i] {
+            for (int r = 0; r < i * records / loggers + 1; ++r)
+                instances[i]->log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "seq {}", r);
+        });
+    }
+    for (auto &producer : producers)
+        producer.join();
+
+    for (int i = 0; i < loggers; ++i)
+    {
+        const int expected = i * records / loggers + 1;
+        ASSERT_TRUE(backends[i]->waitFor(static_cast<std::size_t>(expected)));
+        const auto lines = backends[i]->lines();
+        ASSERT_EQ(lines.size(), static_cast<std::size_t>(expected));
+        for (int r = 0; r < expected; ++r)
+        {
+            const std::string suffix = "seq " + std::to_string(r);
+            EXPECT_EQ(lines[r].substr(lines[r].size() - suffix.size()), suffix);
+        }
+    }
+}
+
+TEST(BackendPoolTest, LoggerDestroyedWhileWorkersAreBusy)
+{
+    zerg::BackendPool pool(2);
+    for (int round = 0; round < 50; ++round)
+    {
+        auto backend = std::make_unique<RecordingBackend>();
+        auto *sink = backend.get();
+        std::size_t written = 0;
+        {
+            PooledLogger logger("unused", zerg::Verbosity::DEBUG_LVL, std::move(backend), &pool);
+            for (int r = 0; r < 500; ++r)
+                logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "round {} {}", round, r);
+            logger.sync();
+            written = sink->lines().size();
+        }
+        EXPECT_EQ(written, 500u);
+    }
+}
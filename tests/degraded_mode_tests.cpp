@@ -0,0 +1,217 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/durable_journal.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace
+{
+using DegradedLogger = zerg::Logger<1024 * 1024 * 1024, 8192>;
+
+// loses everything while failing, like a full disk
+class FlakyBackend : public zerg::ILogBackend
+{
+  public:
+    FlakyBackend(std::string &out, std::mutex &mutex, std::atomic<bool> &failing)
+        : _out(out), _mutex(mutex), _failing(failing)
+    {
+    }
+    void write(const char *data, std::streamsize size) override
+    {
+        if (_failing)
+        {
+            _error = true;
+            return;
+        }
+        std::lock_guard<std::mutex> lock(_mutex);
+        _out.append(data, static_cast<std::size_t>(size));
+    }
+    void writeNewline() override { write("\n", 1); }
+    void flush() override {}
+    void reopen() override { _error = _failing.load(); }
+    bool good() const override { return !_error; }
+
+  private:
+    std::string &_out;
+    std::mutex &_mutex;
+    std::atomic<bool> &_failing;
+    bool _error{false};
+};
+
+std::size_t countOf(const std::string &haystack, const std::string &needle)
+{
+    std::size_t count = 0;
+    for (auto at = haystack.find(needle); at != std::string::npos;
+         at = haystack.find(needle, at + needle.size()))
+    {
+        ++count;
+    }
+    return count;
+}
+} // namespace
+
+TEST(DegradedModeTest, ShedsLowLevelsHoldsWarningsAndRecovers)
+{
+    std::string out;
+    std::mutex mutex;
+    std::atomic<bool> failing{false};
+    DegradedLogger logger("unused.log", zerg::Verbosity::DEBUG_LVL,
+                          std::make_unique<FlakyBackend>(out, mutex, failing));
+
+    logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "healthy");
+    logger.sync();
+    EXPECT_FALSE(logger.degraded());
+
+    failing = true;
+    logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "warning 1");
+    logger.sync();
+    ASSERT_TRUE(logger.degraded());
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        logger.log(zerg::Verbosity::DEBUG_LVL, __FILE__, __LINE__, "noise {}", i);
+    }
+    logger.log(zerg::Verbosity::ERROR_LVL, __FILE__, __LINE__, "error 2");
+    logger.sync();
+    EXPECT_TRUE(logger.degraded());
+
+    failing = false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(DEGRADED_PROBE_MIN_MS * 3));
+    logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "warning 3");
+    logger.sync();
+    EXPECT_FALSE(logger.degraded());
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(countOf(out, "healthy\n"), 1u);
+    EXPECT_EQ(countOf(out, "warning 1\n"), 1u);
+    EXPECT_EQ(countOf(out, "error 2\n"), 1u);
+    EXPECT_EQ(countOf(out, "warning 3\n"), 1u);
+    EXPECT_EQ(countOf(out, "backend recovered after"), 1u);
+    // the probe lets at most one low level record through, the rest never got formatted
+    EXPECT_LE(countOf(out, "noise "), 1u);
+    EXPECT_TRUE(out.find("shed 1000 records") != std::string::npos ||
+                out.find("shed 999 records") != std::string::npos)
+        << out;
+}
+
+TEST(DegradedModeTest, FileBackendReportsDiskFull)
+{
+    for (const bool shared : {false, true})
+    {
+        zerg::FileLogOptions options;
+        options.shared_append = shared;
+        DegradedLogger logger("/dev/full", zerg::Verbosity::DEBUG_LVL,
+                              std::make_unique<zerg::FileLogBackend>("/dev/full", options));
+        for (int i = 0; i < 200 && !logger.degraded(); ++i)
+        {
+            logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "{:>200}", i);
+            logger.sync();
+        }
+        EXPECT_TRUE(logger.degraded()) << "shared_append " << shared;
+    }
+}
+
+TEST(DegradedModeTest, RecoveryInTheDestructorWritesTheSummary)
+{
+    std::string out;
+    std::mutex mutex;
+    std::atomic<bool> failing{true};
+    {
+        DegradedLogger logger("unused.log", zerg::Verbosity::DEBUG_LVL,
+                              std::make_unique<FlakyBackend>(out, mutex, failing));
+        logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "held warning");
+        logger.sync();
+        ASSERT_TRUE(logger.degraded());
+
+        // the backend stays stopped, the destructor's drain writes the last record and
+        // runs the probe that recovers
+        zerg::shutdown(std::chrono::seconds(5));
+        failing = false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(DEGRADED_PROBE_MIN_MS * 3));
+        logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "last warning");
+    }
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(countOf(out, "held warning\n"), 1u);
+    EXPECT_EQ(countOf(out, "last warning\n"), 1u);
+    EXPECT_EQ(countOf(out, "backend recovered after"), 1u) << out;
+}
+
+TEST(DegradedModeTest, HeldRecordsOfAFailedBackendCountAsUnwritten)
+{
+    std::string out;
+    std::mutex mutex;
+    std::atomic<bool> failing{true};
+    testing::internal::CaptureStderr();
+    {
+        DegradedLogger logger("unused.log", zerg::Verbosity::DEBUG_LVL,
+                              std::make_unique<FlakyBackend>(out, mutex, failing));
+        logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "held warning");
+        logger.sync();
+        ASSERT_TRUE(logger.degraded());
+
+        // used to report everything written and drop the held record silently
+        const zerg::ShutdownReport report = zerg::shutdown(std::chrono::seconds(5));
+        EXPECT_EQ(report.unwritten, 1u);
+        EXPECT_TRUE(report.timed_out);
+    }
+    const std::string errors = testing::internal::GetCapturedStderr();
+    EXPECT_NE(errors.find("backend still failing, 1 held records not written"),
+              std::string::npos)
+        << errors;
+
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(countOf(out, "held warning"), 0u);
+}
+
+TEST(DegradedModeTest, JournaledRecordsAreNeverShed)
+{
+    const std::string journal = "degraded_mode_test.journal";
+    std::remove(journal.c_str());
+    std::string out;
+    std::mutex mutex;
+    std::atomic<bool> failing{false};
+    // more than DEGRADED_BUFFER_SIZE of warnings, all of them accepted into the journal
+    constexpr int total = 6000;
+    const std::string payload(1000, 'p');
+    static_assert(total * 1000 > DEGRADED_BUFFER_SIZE);
+    {
+        DegradedLogger logger("unused.log", zerg::Verbosity::DEBUG_LVL,
+                              std::make_unique<FlakyBackend>(out, mutex, failing));
+        logger.enableJournal(journal, 16 * 1024 * 1024);
+        failing = true;
+        for (int i = 0; i < total; ++i)
+        {
+            logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "big {} {}", i, payload);
+            if (i % 1000 == 999)
+                logger.sync();
+        }
+        logger.sync();
+        ASSERT_TRUE(logger.degraded());
+        EXPECT_EQ(logger.droppedCount(), 0u);
+
+        // the probe backoff grew while failing, retry until a probe comes due
+        failing = false;
+        for (int i = 0; i < 200 && logger.degraded(); ++i)
+        {
+            std::this_thread::sleep_for(std::chrono::milliseconds(50));
+            logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "recovered");
+            logger.sync();
+        }
+        EXPECT_FALSE(logger.degraded());
+    }
+
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        // shed records used to be marked done in the journal without being written
+        EXPECT_EQ(countOf(out, "big "), static_cast<std::size_t>(total));
+        EXPECT_NE(out.find("shed 0 that did not fit"), std::string::npos);
+    }
+    EXPECT_TRUE(zerg::DurableJournal(journal).pending().empty());
+    std::remove(journal.c_str());
+}
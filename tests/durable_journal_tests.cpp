@@ -0,0 +1,125 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/durable_journal.hpp"
+#include "test_utils.hpp"
+#include <atomic>
+#include <csignal>
+#include <cstdio>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+// accepts records and never writes them, like a backend stuck on a dead disk
+class StuckBackend : public zerg::ILogBackend
+{
+  public:
+    void write(const char *, std::streamsize) override
+    {
+        for (;;)
+            std::this_thread::sleep_for(std::chrono::seconds(1));
+    }
+    void writeNewline() override {}
+    void flush() override {}
+};
+} // namespace
+
+TEST(DurableJournalTest, RingWrapsAndReclaimsInOrder)
+{
+    const std::string path = "durable_journal_ring_test.journal";
+    std::remove(path.c_str());
+    {
+        zerg::DurableJournal journal(path, 1024);
+        const std::string message(100, 'm');
+        std::vector<std::uint64_t> positions;
+        for (;;)
+        {
+            const auto position = journal.append(zerg::Verbosity::INFO_LVL, "main.cpp", 1,
+                                                 42, message);
+            if (position == zerg::DurableJournal::FULL)
+                break;
+            positions.push_back(position);
+        }
+        ASSERT_GE(positions.size(), 5u);
+        EXPECT_EQ(journal.pending().size(), positions.size());
+
+        // done out of order: the tail only moves past the done prefix
+        journal.markDone(positions[1]);
+        const auto used = journal.used();
+        journal.reclaim();
+        EXPECT_EQ(journal.used(), used);
+        EXPECT_EQ(journal.pending().size(), positions.size() - 1);
+        journal.markDone(positions[0]);
+        journal.reclaim();
+        EXPECT_LT(journal.used(), used);
+        EXPECT_EQ(journal.pending().size(), positions.size() - 2);
+
+        // the freed space is reused, the new record wraps past the end of the ring
+        const auto wrapped = journal.append(zerg::Verbosity::WARN_LVL, "wrap.cpp", 7, 43, "w");
+        ASSERT_NE(wrapped, zerg::DurableJournal::FULL);
+        const auto pending = journal.pending();
+        ASSERT_EQ(pending.size(), positions.size() - 1);
+        EXPECT_EQ(pending.front().position, positions[2]);
+        EXPECT_EQ(pending.back().file, "wrap.cpp");
+        EXPECT_EQ(pending.back().message, "w");
+        EXPECT_EQ(pending.back().line, 7);
+        EXPECT_EQ(pending.back().time_ns, 43);
+    }
+    // what was committed survives reopening
+    {
+        zerg::DurableJournal journal(path);
+        EXPECT_EQ(journal.capacity(), 1024u);
+        EXPECT_FALSE(journal.pending().empty());
+        journal.clear();
+        EXPECT_TRUE(journal.pending().empty());
+    }
+    std::remove(path.c_str());
+}
+
+TEST(DurableJournalTest, KilledProcessRecordsAreReplayed)
+{
+    const std::string filename = "durable_journal_test.log";
+    const std::string journal = "durable_journal_test.journal";
+    removeLogFiles(filename);
+    std::remove(journal.c_str());
+
+    const pid_t child = fork();
+    ASSERT_GE(child, 0);
+    if (child == 0)
+    {
+        // accepted, never written, then the process dies without running any destructor
+        auto *logger = new zerg::Logger<1024 * 1024 * 1024, 4096>(
+            filename, zerg::Verbosity::DEBUG_LVL, std::make_unique<StuckBackend>());
+        logger->enableJournal(journal, 1024 * 1024);
+        for (int i = 0; i < 100; ++i)
+        {
+            logger->log(zerg::Verbosity::INFO_LVL, "audit.cpp", 12, "audit record {}", i);
+        }
+        kill(getpid(), SIGKILL);
+    }
+    int status = 0;
+    waitpid(child, &status, 0);
+    ASSERT_TRUE(WIFSIGNALED(status));
+
+    {
+        zerg::Logger<1024 * 1024 * 1024, 4096> logger(filename);
+        logger.enableJournal(journal, 1024 * 1024);
+        logger.log(zerg::Verbosity::INFO_LVL, "audit.cpp", 20, "after restart");
+        logger.sync();
+    }
+    const std::string content = readFile(filename);
+    for (int i = 0; i < 100; ++i)
+    {
+        EXPECT_NE(content.find("audit.cpp:12 audit record " + std::to_string(i) + "\n"),
+                  std::string::npos)
+            << i;
+    }
+    EXPECT_LT(content.find("audit record 99"), content.find("after restart"));
+    // everything was written, nothing is replayed a second time
+    EXPECT_TRUE(zerg::DurableJournal(journal).pending().empty());
+
+    removeLogFiles(filename);
+    std::remove(journal.c_str());
+}
@@ -0,0 +1,131 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/backend/failover_log_backend.hpp"
+#include "../include/zerg/backend/ring_log_backend.hpp"
+#include <atomic>
+#include <chrono>
+#include <memory>
+#include <mutex>
+#include <string>
+#include <thread>
+
+namespace
+{
+using FailoverLogger = zerg::Logger<1024 * 1024 * 1024, 8192>;
+
+// hangs in write() while the gate is closed, like a stuck mount
+class HangingBackend : public zerg::ILogBackend
+{
+  public:
+    HangingBackend(std::string &out, std::mutex &mutex, std::atomic<bool> &hang)
+        : _out(out), _mutex(mutex), _hang(hang)
+    {
+    }
+    void write(const char *data, std::streamsize size) override
+    {
+        while (_hang)
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        std::lock_guard<std::mutex> lock(_mutex);
+        _out.append(data, static_cast<std::size_t>(size));
+    }
+    void writeNewline() override { write("\n", 1); }
+    void flush() override {}
+
+  private:
+    std::string &_out;
+    std::mutex &_mutex;
+    std::atomic<bool> &_hang;
+};
+
+std::size_t countOf(const std::string &haystack, const std::string &needle)
+{
+    std::size_t count = 0;
+    for (auto at = haystack.find(needle); at != std::string::npos;
+         at = haystack.find(needle, at + needle.size()))
+    {
+        ++count;
+    }
+    return count;
+}
+} // namespace
+
+TEST(FailoverBackendTest, HungPrimaryFailsOverAndBack)
+{
+    std::string primary_out;
+    std::mutex mutex;
+    std::atomic<bool> hang{false};
+    auto ring = std::make_unique<zerg::RingLogBackend>();
+    zerg::RingLogBackend *secondary = ring.get();
+    auto backend = std::make_unique<zerg::FailoverLogBackend>(
+        std::make_unique<HangingBackend>(primary_out, mutex, hang), std::move(ring),
+        std::chrono::milliseconds(50), std::chrono::milliseconds(100));
+    zerg::FailoverLogBackend *failover = backend.get();
+    FailoverLogger logger("unused.log", zerg::Verbosity::DEBUG_LVL, std::move(backend));
+
+    logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "before hang");
+    logger.sync();
+    EXPECT_FALSE(failover->failedOver());
+
+    hang = true;
+    const auto start = std::chrono::steady_clock::now();
+    for (int i = 0; i < 2000; ++i)
+    {
+        logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "during hang {}", i);
+    }
+    logger.sync();
+    // one deadline, not the length of the hang
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(2));
+    EXPECT_TRUE(failover->failedOver());
+    EXPECT_EQ(failover->failovers(), 1u);
+    EXPECT_EQ(logger.droppedCount(), 0u);
+    const std::string held = secondary->snapshot();
+    for (int i = 0; i < 2000; ++i)
+    {
+        EXPECT_EQ(countOf(held, "during hang " + std::to_string(i) + "\n"), 1u) << i;
+    }
+
+    hang = false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(200));
+    logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "after recovery");
+    logger.sync();
+    EXPECT_FALSE(failover->failedOver());
+    std::lock_guard<std::mutex> lock(mutex);
+    EXPECT_EQ(countOf(primary_out, "before hang\n"), 1u);
+    EXPECT_EQ(countOf(primary_out, "after recovery\n"), 1u);
+    EXPECT_EQ(countOf(secondary->snapshot(), "after recovery"), 0u);
+}
+
+TEST(FailoverBackendTest, DestructorDoesNotWaitForHungPrimary)
+{
+    // outlives the test: the abandoned I/O thread returns once it opens
+    static std::string out;
+    static std::mutex mutex;
+    static std::atomic<bool> hang;
+    hang = true;
+    const auto start = std::chrono::steady_clock::now();
+    {
+        zerg::FailoverLogBackend backend(std::make_unique<HangingBackend>(out, mutex, hang),
+                                         std::make_unique<zerg::RingLogBackend>(64),
+                                         std::chrono::milliseconds(50));
+        for (int i = 0; i < 10; ++i)
+        {
+            backend.writeRecord("0123456789abcdef", 16, {});
+        }
+        backend.flush();
+        EXPECT_TRUE(backend.failedOver());
+    }
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::seconds(1));
+    hang = false;
+}
+
+TEST(RingLogBackendTest, EvictsOldestWholeRecords)
+{
+    zerg::RingLogBackend ring(40);
+    for (int i = 0; i < 10; ++i)
+    {
+        const std::string record = "record " + std::to_string(i);
+        ring.writeRecord(record.data(), static_cast<std::streamsize>(record.size()), {});
+    }
+    EXPECT_EQ(ring.snapshot(), "record 6\nrecord 7\nrecord 8\nrecord 9\n");
+    EXPECT_EQ(ring.evicted(), 6u);
+}
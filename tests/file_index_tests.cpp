@@ -0,0 +1,71 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/backend/file_index.hpp"
+#include "test_utils.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+TEST(FileIndexTest, IndexEntriesPointAtRecordStarts)
+{
+    const std::string filename = "file_index_test.log";
+    removeLogFiles(filename);
+    {
+        zerg::Logger<1024 * 1024 * 1024, 4096> logger(
+            filename, zerg::Verbosity::DEBUG_LVL,
+            std::make_unique<zerg::FileLogBackend>(filename, zerg::FileLogOptions{true, 512}));
+        logger.setSequenceNumbers(true);
+        for (int i = 0; i < 1000; ++i)
+        {
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "indexed record {}", i);
+        }
+        // let the backend thread write everything, sync() would drain concurrently with it
+        logger.waitUntilEmpty();
+    }
+
+    std::ifstream in(filename, std::ios::binary);
+    const std::string data((std::istreambuf_iterator<char>(in)), std::istreambuf_iterator<char>());
+    const auto index = zerg::readFileIndex(zerg::fileIndexPath(filename));
+    ASSERT_GT(index.size(), 10u);
+    EXPECT_EQ(index.front().offset, 0u);
+    for (std::size_t i = 0; i < index.size(); ++i)
+    {
+        ASSERT_LT(index[i].offset, data.size());
+        if (i > 0)
+        {
+            EXPECT_GE(index[i].offset, index[i - 1].offset + 512);
+            EXPECT_GT(index[i].sequence, index[i - 1].sequence);
+            EXPECT_GE(index[i].timestamp_ns, index[i - 1].timestamp_ns);
+            EXPECT_EQ(data[index[i].offset - 1], '\n');
+        }
+        // the record at the offset carries the indexed sequence number
+        const std::string expected = "#" + std::to_string(index[i].sequence) + " ";
+        EXPECT_EQ(data.compare(data.find(" [", index[i].offset) + 8, expected.size(), expected), 0)
+            << data.substr(index[i].offset, 80);
+    }
+    EXPECT_LE(zerg::indexStartOffset(index, index.back().timestamp_ns), index.back().offset);
+    EXPECT_EQ(zerg::indexStartOffset(index, index.front().timestamp_ns - 1), 0u);
+
+    // reopening appends to both the log and the index
+    {
+        zerg::FileLogBackend backend(filename, zerg::FileLogOptions{true, 512});
+        backend.writeRecord("appended", 8, {index.back().timestamp_ns + 1, 1000});
+        backend.flush();
+    }
+    const auto reopened = zerg::readFileIndex(zerg::fileIndexPath(filename));
+    ASSERT_EQ(reopened.size(), index.size() + 1);
+    EXPECT_EQ(reopened.back().offset, data.size());
+    EXPECT_EQ(reopened.back().sequence, 1000u);
+
+    removeLogFiles(filename);
+}
+
+TEST(FileIndexTest, RejectsForeignIndex)
+{
+    const std::string path = "foreign_index_test.idx";
+    std::ofstream(path) << "not an index at all";
+    EXPECT_THROW(zerg::readFileIndex(path), std::runtime_error);
+    EXPECT_TRUE(zerg::readFileIndex("missing_index_test.idx").empty());
+    std::remove(path.c_str());
+}
@@ -0,0 +1,106 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "test_utils.hpp"
+#include <atomic>
+#include <cstdio>
+#include <string>
+#include <sys/wait.h>
+#include <thread>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+// Fork while another thread keeps logging; each child logs one record and syncs, which
+// used to deadlock. Returns the pids of the children, all of which exited cleanly
+template <typename Logger>
+std::vector<pid_t> forkWhileLogging(Logger &logger, const std::string &tag)
+{
+    std::atomic<bool> stop{false};
+    std::thread producer([&] {
+        for (int i = 0; !stop.load(); ++i)
+        {
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "{} background {}", tag,
+                       i);
+        }
+    });
+    std::this_thread::sleep_for(std::chrono::milliseconds(20));
+
+    std::vector<pid_t> children;
+    for (int c = 0; c < 3; ++c)
+    {
+        const pid_t child = fork();
+        if (child == 0)
+        {
+            // a deadlocked child is killed instead of hanging the test
+            alarm(10);
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "{} child {}", tag,
+                       getpid());
+            logger.sync();
+            _exit(0);
+        }
+        children.push_back(child);
+    }
+    stop = true;
+    producer.join();
+    logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "{} parent after fork", tag);
+    logger.sync();
+
+    for (const pid_t child : children)
+    {
+        int status = 0;
+        waitpid(child, &status, 0);
+        EXPECT_TRUE(WIFEXITED(status) && WEXITSTATUS(status) == 0) << "child " << child;
+    }
+    return children;
+}
+} // namespace
+
+TEST(ForkSafetyTest, ChildLogsToPerPidFile)
+{
+    const std::string filename = "fork_safety_test.log";
+    removeLogFiles(filename);
+    std::vector<pid_t> children;
+    {
+        zerg::Logger<1024 * 1024 * 1024, 4096> logger(filename);
+        logger.setFormatterThreads(2);
+        logger.setReopenOnFork(true);
+        children = forkWhileLogging(logger, "dedicated");
+    }
+
+    const std::string parent = readFile(filename);
+    EXPECT_NE(parent.find("dedicated parent after fork"), std::string::npos);
+    EXPECT_EQ(parent.find("dedicated child"), std::string::npos);
+    for (const pid_t child : children)
+    {
+        const std::string child_file = filename + "." + std::to_string(child);
+        const std::string content = readFile(child_file);
+        // its own record, none of the parent's backlog
+        EXPECT_NE(content.find("dedicated child " + std::to_string(child)), std::string::npos);
+        EXPECT_EQ(content.find("background"), std::string::npos);
+        removeLogFiles(child_file);
+    }
+    removeLogFiles(filename);
+}
+
+TEST(ForkSafetyTest, PooledLoggerSurvivesFork)
+{
+    const std::string filename = "fork_safety_pool_test.log";
+    removeLogFiles(filename);
+    std::vector<pid_t> children;
+    {
+        zerg::BackendPool pool(2);
+        zerg::Logger<1024 * 1024 * 1024, 4096> logger(filename, zerg::Verbosity::DEBUG_LVL,
+                                                       nullptr, &pool);
+        children = forkWhileLogging(logger, "pooled");
+    }
+
+    // without reopening, children append to the parent's file
+    const std::string content = readFile(filename);
+    EXPECT_NE(content.find("pooled parent after fork"), std::string::npos);
+    for (const pid_t child : children)
+    {
+        EXPECT_NE(content.find("pooled child " + std::to_string(child)), std::string::npos);
+    }
+    removeLogFiles(filename);
+}
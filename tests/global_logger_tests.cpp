@@ -1,5 +1,6 @@
 #include <gtest/gtest.h>
 #include "../include/zerg/global/file_logger.hpp"
+#include "../include/zerg/global/console_logger.hpp"
 #include "test_utils.hpp"
 #include <string>
 #include <thread>
@@ -130,4 +131,24 @@ TEST(GlobalLoggerTest, ThreadSafety_Resilient)
 
     int expected_total = num_threads * messages_per_thread;
     EXPECT_GE(message_count, static_cast<int>(0.99 * expected_total));
-}
\ No newline at end of file
+}
+
+TEST(GlobalLoggerTest, ExitWithLiveGlobalLoggers)
+{
+    const std::string filename = "exit_logfile.log";
+    removeLogFiles(filename);
+
+    // a fresh process, so the global logger statics are the first statics constructed and the
+    // logger destructors run last, during exit()
+    GTEST_FLAG_SET(death_test_style, "threadsafe");
+    EXPECT_EXIT(
+        {
+            cpp_log_with_file(zerg::Verbosity::INFO_LVL, filename, "Written at exit");
+            cpp_log_console(zerg::Verbosity::INFO_LVL, "Written at exit");
+            std::exit(0);
+        },
+        testing::ExitedWithCode(0), "");
+
+    EXPECT_NE(readFile(filename).find("Written at exit"), std::string::npos);
+    removeLogFiles(filename);
+}
@@ -19,6 +19,20 @@ TEST_F(LockFreeQueueTest, EnqueueDequeueBasic)
     EXPECT_EQ(value, 42);
 }
 
+TEST_F(LockFreeQueueTest, DequeueTicketsFollowEnqueueOrder)
+{
+    int value;
+    size_t ticket;
+    // wrap around the ring a few times, tickets keep counting
+    for (size_t i = 0; i < 3 * DEFAULT_CAPACITY; ++i)
+    {
+        ASSERT_TRUE(queue.enqueue(static_cast<int>(i)));
+        ASSERT_TRUE(queue.dequeue(value, ticket));
+        EXPECT_EQ(ticket, i);
+        EXPECT_EQ(value, static_cast<int>(i));
+    }
+}
+
 TEST_F(LockFreeQueueTest, EmptyQueueBehavior)
 {
     int value;
@@ -0,0 +1,159 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/log_reopen.hpp"
+#include "test_utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <csignal>
+#include <cstdio>
+#include <memory>
+#include <mutex>
+#include <stdexcept>
+#include <string>
+#include <thread>
+
+namespace
+{
+using ReopenLogger = zerg::Logger<1024 * 1024 * 1024, 8192>;
+
+std::size_t countOf(const std::string &haystack, const std::string &needle)
+{
+    std::size_t count = 0;
+    for (auto at = haystack.find(needle); at != std::string::npos;
+         at = haystack.find(needle, at + needle.size()))
+    {
+        ++count;
+    }
+    return count;
+}
+
+// a sink whose reopen() throws while fail is set
+class ThrowingReopenBackend : public zerg::ILogBackend
+{
+  public:
+    explicit ThrowingReopenBackend(std::atomic<bool> &fail) : _fail(fail) {}
+    void write(const char *data, std::streamsize size) override
+    {
+        std::lock_guard<std::mutex> lock(mutex);
+        content.append(data, static_cast<std::size_t>(size));
+    }
+    void writeNewline() override { write("\n", 1); }
+    void flush() override {}
+    void reopen() override
+    {
+        if (_fail.load())
+            throw std::runtime_error("cannot reopen");
+    }
+
+    std::mutex mutex;
+    std::string content;
+
+  private:
+    std::atomic<bool> &_fail;
+};
+
+template <typename Predicate> bool waitFor(Predicate predicate)
+{
+    const auto until = std::chrono::steady_clock::now() + std::chrono::seconds(5);
+    while (!predicate())
+    {
+        if (std::chrono::steady_clock::now() > until)
+            return false;
+        std::this_thread::sleep_for(std::chrono::milliseconds(1));
+    }
+    return true;
+}
+} // namespace
+
+TEST(LogReopenTest, SighupAfterRenameLosesAndDuplicatesNothing)
+{
+    const std::string file = "reopen_test.log";
+    const std::string rotated = "reopen_test.log.1";
+    removeLogFiles(file);
+    removeLogFiles(rotated);
+    ASSERT_TRUE(zerg::installReopenHandler());
+
+    constexpr int records = 4000;
+    {
+        ReopenLogger logger(file);
+        std::thread producer([&] {
+            for (int i = 0; i < records; ++i)
+            {
+                logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "record {}", i);
+                if (i % 64 == 0)
+                    std::this_thread::yield();
+            }
+        });
+        // logrotate: rename while records are in flight, then signal
+        std::this_thread::sleep_for(std::chrono::milliseconds(2));
+        ASSERT_EQ(std::rename(file.c_str(), rotated.c_str()), 0);
+        ASSERT_EQ(std::raise(SIGHUP), 0);
+        producer.join();
+        logger.sync();
+    }
+
+    const std::string old_content = readFile(rotated);
+    const std::string new_content = readFile(file);
+    EXPECT_FALSE(new_content.empty());
+    for (int i = 0; i < records; ++i)
+    {
+        const std::string record = "record " + std::to_string(i) + "\n";
+        ASSERT_EQ(countOf(old_content, record) + countOf(new_content, record), 1u) << record;
+    }
+    removeLogFiles(file);
+    removeLogFiles(rotated);
+}
+
+TEST(LogReopenTest, SharedAppendReopenKeepsRecordsWhole)
+{
+    const std::string file = "reopen_shared_test.log";
+    const std::string rotated = "reopen_shared_test.log.1";
+    removeLogFiles(file);
+    removeLogFiles(rotated);
+
+    zerg::FileLogOptions options;
+    options.shared_append = true;
+    {
+        ReopenLogger logger(file, zerg::Verbosity::DEBUG_LVL,
+                            std::make_unique<zerg::FileLogBackend>(file, options));
+        logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "before rotation");
+        logger.sync();
+        ASSERT_EQ(std::rename(file.c_str(), rotated.c_str()), 0);
+        logger.reopen();
+        logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "after rotation");
+        logger.sync();
+    }
+
+    const std::string old_content = readFile(rotated);
+    const std::string new_content = readFile(file);
+    EXPECT_EQ(countOf(old_content, "before rotation\n"), 1u);
+    EXPECT_EQ(countOf(old_content, "after rotation"), 0u);
+    EXPECT_EQ(countOf(new_content, "after rotation\n"), 1u);
+    EXPECT_EQ(countOf(new_content, "before rotation"), 0u);
+    removeLogFiles(file);
+    removeLogFiles(rotated);
+}
+
+TEST(LogReopenTest, ThrowingReopenDegradesInsteadOfTerminating)
+{
+    std::atomic<bool> fail{true};
+    auto backend = std::make_unique<ThrowingReopenBackend>(fail);
+    ThrowingReopenBackend *sink = backend.get();
+    ReopenLogger logger("unused", zerg::Verbosity::DEBUG_LVL, std::move(backend));
+
+    // the reopen runs on the backend thread before this record is written
+    zerg::requestReopen();
+    logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "held record");
+    ASSERT_TRUE(waitFor([&] { return logger.degraded(); }));
+
+    // the next probe reopens, writes what was held and recovers
+    fail = false;
+    std::this_thread::sleep_for(std::chrono::milliseconds(DEGRADED_PROBE_MIN_MS + 20));
+    logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "after recovery");
+    ASSERT_TRUE(waitFor([&] { return !logger.degraded(); }));
+    logger.sync();
+    std::lock_guard<std::mutex> lock(sink->mutex);
+    EXPECT_NE(sink->content.find("held record"), std::string::npos);
+    EXPECT_NE(sink->content.find("after recovery"), std::string::npos);
+    EXPECT_NE(sink->content.find("backend recovered"), std::string::npos);
+}
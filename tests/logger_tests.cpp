@@ -1,10 +1,75 @@
 #include <gtest/gtest.h>
 #include "../include/zerg/logger.hpp"
 #include "test_utils.hpp"
+#include <atomic>
+#include <chrono>
 #include <string>
+#include <thread>
+#include <vector>
 
 #define LOG_TEST(logger, level, ...) logger.log(level, __FILE__, __LINE__, __VA_ARGS__)
 
+namespace
+{
+// backend that holds every write until the test opens the gate
+class GatedBackend : public zerg::ILogBackend
+{
+  public:
+    GatedBackend(std::atomic<bool> &open, std::atomic<int> &writes) : _open(open), _writes(writes)
+    {
+    }
+    void write(const char *, std::streamsize) override
+    {
+        while (!_open.load())
+            std::this_thread::yield();
+        ++_writes;
+    }
+    void writeNewline() override {}
+    void flush() override {}
+
+  private:
+    std::atomic<bool> &_open;
+    std::atomic<int> &_writes;
+};
+
+// gated backend that also keeps every record it was given
+class CaptureBackend : public zerg::ILogBackend
+{
+  public:
+    CaptureBackend(std::atomic<bool> &open, std::vector<std::string> &records)
+        : _open(open), _records(records)
+    {
+    }
+    void write(const char *data, std::streamsize size) override
+    {
+        while (!_open.load())
+            std::this_thread::yield();
+        _records.emplace_back(data, static_cast<std::size_t>(size));
+        _count.store(_records.size());
+    }
+    void writeNewline() override {}
+    void flush() override {}
+
+    // wait for the backend thread itself (sync() would drain on the caller concurrently)
+    bool waitFor(const std::size_t count) const
+    {
+        const auto deadline = std::chrono::steady_clock::now() + std::chrono::seconds(10);
+        while (_count.load() < count)
+        {
+            if (std::chrono::steady_clock::now() > deadline)
+                return false;
+            std::this_thread::sleep_for(std::chrono::milliseconds(1));
+        }
+        return true;
+    }
+
+  private:
+    std::atomic<bool> &_open;
+    std::vector<std::string> &_records;
+    std::atomic<std::size_t> _count{0};
+};
+} // namespace
+
 TEST(LoggerTest, LogSingleMessage)
 {
     const std::string filename = "test_log.log";
@@ -113,4 +178,172 @@ TEST(LoggerTest, SanitizeNonPrintableCharacters)
     EXPECT_EQ(log_content.find("\x01"), std::string::npos);
     EXPECT_EQ(log_content.find("\x02"), std::string::npos);
     EXPECT_EQ(log_content.find("\x03"), std::string::npos);
-}
\ No newline at end of file
+}
+
+TEST(LoggerTest, DroppedCountWhenQueueFull)
+{
+    std::atomic<bool> open{false};
+    std::atomic<int> writes{0};
+    zerg::Logger<1024 * 1024, 8> logger("unused_dropped.log", zerg::Verbosity::DEBUG_LVL,
+                                        std::make_unique<GatedBackend>(open, writes));
+
+    EXPECT_EQ(logger.droppedCount(), 0u);
+    constexpr int total = 100;
+    for (int i = 0; i < total; ++i)
+    {
+        LOG_TEST(logger, zerg::Verbosity::INFO_LVL, "Message {}", i);
+    }
+    EXPECT_GT(logger.droppedCount(), 0u);
+
+    open = true;
+    logger.sync();
+    logger.waitUntilEmpty();
+
+    EXPECT_EQ(static_cast<std::size_t>(writes.load()) + logger.droppedCount(),
+              static_cast<std::size_t>(total));
+}
+
+TEST(LoggerTest, VlogFormatsPackedArguments)
+{
+    const std::string filename = "vlog_test.log";
+    {
+        std::ofstream ofs(filename, std::ofstream::out | std::ofstream::trunc);
+    }
+    {
+        zerg::Logger<1024 * 1024> logger(filename, zerg::Verbosity::DEBUG_LVL);
+
+        const int id = 7;
+        const std::string name = "packed";
+        logger.vlog(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "vlog {} {}",
+                    fmt::make_format_args(id, name));
+
+        logger.sync();
+        logger.waitUntilEmpty();
+    }
+
+    std::string log_content = readFile(filename);
+    EXPECT_NE(log_content.find("vlog 7 packed"), std::string::npos);
+    removeLogFiles(filename);
+}
+
+TEST(LoggerTest, FormatterThreadsPreserveOrder)
+{
+    std::atomic<bool> open{false};
+    std::vector<std::string> records;
+    auto backend = std::make_unique<CaptureBackend>(open, records);
+    const CaptureBackend *capture = backend.get();
+    zerg::Logger<1024 * 1024 * 1024, 16 * 1024> logger(
+        "unused_parallel.log", zerg::Verbosity::DEBUG_LVL, std::move(backend));
+    logger.setFormatterThreads(3);
+
+    // the first record parks the backend in write(), the rest drain as one large batch
+    constexpr int total = 8000;
+    for (int i = 0; i < total; ++i)
+    {
+        LOG_TEST(logger, zerg::Verbosity::INFO_LVL, "ordered {}", i);
+    }
+    open = true;
+    ASSERT_TRUE(capture->waitFor(total));
+
+    ASSERT_EQ(records.size(), static_cast<std::size_t>(total));
+    for (int i = 0; i < total; ++i)
+    {
+        ASSERT_NE(records[i].find("ordered " + std::to_string(i)), std::string::npos)
+            << "record " << i << " out of order: " << records[i];
+    }
+}
+
+TEST(LoggerTest, BusyPollStampsRecordsOnProducer)
+{
+    std::atomic<bool> open{true};
+    std::vector<std::string> records;
+    auto backend = std::make_unique<CaptureBackend>(open, records);
+    const CaptureBackend *capture = backend.get();
+    zerg::Logger<1024 * 1024 * 1024, 1024> logger("unused_busy_poll.log",
+                                                  zerg::Verbosity::DEBUG_LVL, std::move(backend));
+    logger.enableBusyPoll();
+
+    constexpr int total = 200;
+    for (int i = 0; i < total; ++i)
+    {
+        LOG_TEST(logger, zerg::Verbosity::INFO_LVL, "spin {}", i);
+    }
+    ASSERT_TRUE(capture->waitFor(total));
+
+    const std::time_t now = std::time(nullptr);
+    std::tm tm_now{};
+    localtime_r(&now, &tm_now);
+    char year[8];
+    std::strftime(year, sizeof(year), "%Y-", &tm_now);
+    for (int i = 0; i < total; ++i)
+    {
+        EXPECT_EQ(records[i].rfind(year, 0), 0u) << records[i];
+        EXPECT_NE(records[i].find("spin " + std::to_string(i)), std::string::npos);
+    }
+}
+
+TEST(LoggerTest, BusyPollRejectsPooledLogger)
+{
+    {
+        zerg::BackendPool pool(1);
+        zerg::Logger<1024 * 1024 * 1024, 1024> logger("unused_busy_pool.log",
+                                                      zerg::Verbosity::DEBUG_LVL, nullptr, &pool);
+        EXPECT_THROW(logger.enableBusyPoll(), std::runtime_error);
+    }
+    removeLogFiles("unused_busy_pool.log");
+}
+
+TEST(LoggerTest, BusyPollRejectsCpuItCannotPin)
+{
+    std::atomic<bool> open{true};
+    std::vector<std::string> records;
+    auto backend = std::make_unique<CaptureBackend>(open, records);
+    const CaptureBackend *capture = backend.get();
+    zerg::Logger<1024 * 1024 * 1024, 1024> logger("unused_busy_pin.log",
+                                                  zerg::Verbosity::DEBUG_LVL, std::move(backend));
+    // no such cpu: used to spin unpinned without a word
+    EXPECT_THROW(logger.enableBusyPoll(CPU_SETSIZE - 1), std::runtime_error);
+
+    // still the regular backend thread
+    LOG_TEST(logger, zerg::Verbosity::INFO_LVL, "not spinning");
+    ASSERT_TRUE(capture->waitFor(1));
+    EXPECT_NE(records[0].find("not spinning"), std::string::npos);
+}
+
+TEST(LoggerTest, SequenceNumbersRestoreOrderAndShowDrops)
+{
+    std::atomic<bool> open{false};
+    std::vector<std::string> records;
+    auto backend = std::make_unique<CaptureBackend>(open, records);
+    const CaptureBackend *capture = backend.get();
+    zerg::Logger<1024 * 1024 * 1024, 64> logger("unused_sequence.log", zerg::Verbosity::DEBUG_LVL,
+                                                std::move(backend));
+    logger.setSequenceNumbers(true, true);
+
+    // the backend parks on the first record, so most of these overflow the 64 slot queue
+    constexpr int total = 500;
+    for (int i = 0; i < total; ++i)
+    {
+        LOG_TEST(logger, zerg::Verbosity::INFO_LVL, "seq {}", i);
+    }
+    const std::size_t dropped = logger.droppedCount();
+    ASSERT_GT(dropped, 0u);
+    open = true;
+    ASSERT_TRUE(capture->waitFor(total - dropped));
+
+    // "#<global> t<thread>:<per thread>": global is gap free, per thread counts the drops
+    std::size_t gaps = 0;
+    long previous_thread_seq = -1;
+    for (std::size_t i = 0; i < records.size(); ++i)
+    {
+        const auto hash = records[i].find(" #");
+        ASSERT_NE(hash, std::string::npos) << records[i];
+        EXPECT_EQ(std::stoul(records[i].substr(hash + 2)), i);
+        const auto colon = records[i].find(':', records[i].find(" t", hash));
+        const long thread_seq = std::stol(records[i].substr(colon + 1));
+        gaps += static_cast<std::size_t>(thread_seq - previous_thread_seq - 1);
+        previous_thread_seq = thread_seq;
+    }
+    gaps += static_cast<std::size_t>(total - 1 - previous_thread_seq);
+    EXPECT_EQ(gaps, dropped);
+}
@@ -0,0 +1,114 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/rate_quota.hpp"
+#include "test_utils.hpp"
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using QuotaLogger = zerg::Logger<1024 * 1024 * 1024, 8192>;
+constexpr std::int64_t MS = 1000000;
+} // namespace
+
+TEST(RateQuotaTest, TokenBucketRefillsAtRate)
+{
+    zerg::TokenBucket bucket;
+    bucket.configure(1000, std::chrono::milliseconds(100)); // 100 at once, 1 per ms
+    const std::int64_t start = 1000 * MS;
+    int admitted = 0;
+    while (bucket.tryAcquire(1, start))
+        ++admitted;
+    EXPECT_EQ(admitted, 100);
+
+    admitted = 0;
+    while (bucket.tryAcquire(1, start + 50 * MS))
+        ++admitted;
+    EXPECT_EQ(admitted, 50);
+
+    // idle long enough: one oversized request still gets through, then nothing
+    EXPECT_TRUE(bucket.tryAcquire(500, start + 1000 * MS));
+    EXPECT_FALSE(bucket.tryAcquire(1, start + 1000 * MS));
+}
+
+TEST(RateQuotaTest, ConcurrentProducersNeverOvershoot)
+{
+    zerg::TokenBucket bucket;
+    bucket.configure(1000, std::chrono::milliseconds(1000));
+    const std::int64_t now = 5000 * MS;
+    std::atomic<int> admitted{0};
+    std::vector<std::thread> threads;
+    for (int t = 0; t < 8; ++t)
+    {
+        threads.emplace_back([&] {
+            for (int i = 0; i < 10000; ++i)
+            {
+                if (bucket.tryAcquire(1, now))
+                    ++admitted;
+            }
+        });
+    }
+    for (auto &thread : threads)
+        thread.join();
+    EXPECT_EQ(admitted.load(), 1000);
+}
+
+TEST(RateQuotaTest, EstimateCountsStringArguments)
+{
+    const std::string payload(1000, 'x');
+    EXPECT_EQ(zerg::estimateRecordSize("{} {}", payload, 42),
+              QUOTA_RECORD_OVERHEAD + 5 + 1000 + QUOTA_ARG_ESTIMATE);
+    EXPECT_EQ(zerg::estimateRecordSize("{}", "abc"), QUOTA_RECORD_OVERHEAD + 2 + 3);
+}
+
+TEST(RateQuotaTest, LoggerRejectsOverQuotaBeforeFormatting)
+{
+    const std::string file = "rate_quota_test.log";
+    removeLogFiles(file);
+    QuotaLogger logger(file);
+    zerg::LogQuota quota;
+    quota.records_per_second = 100;
+    quota.burst = std::chrono::milliseconds(1000);
+    logger.setQuota(quota);
+
+    for (int i = 0; i < 1000; ++i)
+    {
+        logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "record {}", i);
+    }
+    logger.sync();
+    const std::string content = readFile(file);
+    const auto written = static_cast<std::size_t>(std::count(content.begin(), content.end(), '\n'));
+    EXPECT_GE(written, 100u);
+    EXPECT_LT(written, 150u);
+    EXPECT_EQ(written + logger.quotaViolations(), 1000u);
+    EXPECT_EQ(logger.droppedCount(), 0u);
+
+    // byte quota on top: 10 KB/s fits about nine records of 1 KB
+    zerg::LogQuota bytes;
+    bytes.bytes_per_second = 10000;
+    logger.setQuota(bytes);
+    const std::size_t before = logger.quotaViolations();
+    const std::string payload(1000, 'x');
+    for (int i = 0; i < 100; ++i)
+    {
+        logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "big {} {}", i, payload);
+    }
+    logger.sync();
+    const std::size_t rejected = logger.quotaViolations() - before;
+    EXPECT_GE(rejected, 85u);
+    EXPECT_LE(rejected, 92u);
+
+    // lifting the quota
+    logger.setQuota({});
+    for (int i = 0; i < 1000; ++i)
+    {
+        logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "free {}", i);
+    }
+    EXPECT_EQ(logger.quotaViolations(), before + rejected);
+    removeLogFiles(file);
+}
@@ -0,0 +1,158 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/backend/record_frame.hpp"
+#include "test_utils.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+
+namespace
+{
+std::string readAll(const std::string &filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    return {std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>()};
+}
+
+zerg::FileLogOptions framedOptions()
+{
+    zerg::FileLogOptions options;
+    options.index = true;
+    options.index_interval = 256;
+    options.framing = true;
+    return options;
+}
+} // namespace
+
+TEST(RecordFrameTest, Crc32cMatchesKnownVectors)
+{
+    EXPECT_EQ(zerg::crc32c("123456789", 9), 0xE3069283u);
+    EXPECT_EQ(zerg::crc32c("", 0), 0u);
+    // chained and unaligned input agree with the one shot result, hardware or table
+    const std::string text = "2025-01-31 12:00:00 [INFO] main.cpp:42 request 17 took 3.5 ms";
+    const auto whole = zerg::crc32c(text.data(), text.size());
+    EXPECT_EQ(zerg::crc32c(text.data() + 13, text.size() - 13, zerg::crc32c(text.data(), 13)),
+              whole);
+    EXPECT_EQ(zerg::crc32c_detail::software(~0u, reinterpret_cast<const unsigned char *>(
+                                                         text.data()),
+                                            text.size()),
+              ~whole);
+}
+
+TEST(RecordFrameTest, ReopenTruncatesTornTail)
+{
+    const std::string filename = "record_frame_test.log";
+    removeLogFiles(filename);
+    {
+        zerg::Logger<1024 * 1024 * 1024, 4096> logger(
+            filename, zerg::Verbosity::DEBUG_LVL,
+            std::make_unique<zerg::FileLogBackend>(filename, framedOptions()));
+        for (int i = 0; i < 200; ++i)
+        {
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "framed record {}", i);
+        }
+        logger.waitUntilEmpty();
+    }
+    const std::string clean = readAll(filename);
+    auto scan = zerg::scanFrames(filename);
+    EXPECT_EQ(scan.records, 200u);
+    EXPECT_EQ(scan.valid_end, clean.size());
+    EXPECT_TRUE(scan.bad.empty());
+
+    // a crash mid-write: a record whose checksum does not match, then one cut short and
+    // the zero filled block the filesystem allocated for it
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::app);
+        out << "2025-01-31 12:00:00 [INFO] record with a stale checksum ~00000000\n";
+        out << "2025-01-31 12:00:00 [INFO] torn record that never got its tra";
+        out << std::string(64, '\0');
+    }
+    const std::size_t torn = readAll(filename).size() - clean.size();
+    {
+        zerg::FileLogBackend backend(filename, framedOptions());
+        EXPECT_EQ(backend.recoveredBytes(), torn);
+        backend.writeRecord("after recovery", 14, {1, 200});
+        backend.flush();
+    }
+    const std::string recovered = readAll(filename);
+    EXPECT_EQ(recovered.compare(0, clean.size(), clean), 0);
+    EXPECT_EQ(recovered.substr(clean.size(), 15), "after recovery ");
+    scan = zerg::scanFrames(filename);
+    EXPECT_EQ(scan.records, 201u);
+    EXPECT_TRUE(scan.bad.empty());
+    for (const auto &entry : zerg::readFileIndex(zerg::fileIndexPath(filename)))
+        EXPECT_LT(entry.offset, recovered.size());
+
+    removeLogFiles(filename);
+}
+
+TEST(RecordFrameTest, ScanFindsCorruptionMidFile)
+{
+    const std::string filename = "record_frame_corrupt_test.log";
+    removeLogFiles(filename);
+    {
+        std::ofstream out(filename, std::ios::binary);
+        // written before framing was enabled, recovery must leave it alone
+        out << "unframed line\n";
+    }
+    {
+        zerg::FileLogBackend backend(filename, framedOptions());
+        EXPECT_EQ(backend.recoveredBytes(), 0u);
+        for (int i = 0; i < 3; ++i)
+        {
+            const std::string record = "record " + std::to_string(i);
+            backend.writeRecord(record.data(), static_cast<std::streamsize>(record.size()), {});
+        }
+    }
+    std::string data = readAll(filename);
+    const auto second = data.find("record 1");
+    data[second + 3] = 'X';
+    {
+        std::ofstream out(filename, std::ios::binary | std::ios::trunc);
+        out << data;
+    }
+
+    const auto scan = zerg::scanFrames(filename);
+    EXPECT_EQ(scan.records, 2u);
+    EXPECT_EQ(scan.valid_end, data.size());
+    ASSERT_EQ(scan.bad.size(), 2u);
+    EXPECT_EQ(scan.bad[0], 0u);
+    EXPECT_EQ(scan.bad[1], second);
+    // the last frame is intact, so reopening keeps everything
+    EXPECT_EQ(zerg::recoverFramedLog(filename), 0u);
+
+    removeLogFiles(filename);
+}
+
+TEST(RecordFrameTest, FailedRecoveryOnReopenLeavesBackendNotGood)
+{
+    const std::string filename = "record_frame_reopen_test.log";
+    removeLogFiles(filename);
+    zerg::FileLogBackend backend(filename, framedOptions());
+    backend.writeRecord("before rotation", 15, {1, 0});
+    backend.flush();
+
+    // logrotate moved the file away, what is at the path now has a torn tail and an index
+    // that is not ours: recovery throws, reopen() must not
+    std::rename(filename.c_str(), (filename + ".1").c_str());
+    std::rename(zerg::fileIndexPath(filename).c_str(),
+                zerg::fileIndexPath(filename + ".1").c_str());
+    {
+        std::ofstream out(filename, std::ios::binary);
+        out << "torn record";
+        std::ofstream index(zerg::fileIndexPath(filename), std::ios::binary);
+        index << "not an index";
+    }
+    EXPECT_NO_THROW(backend.reopen());
+    EXPECT_FALSE(backend.good());
+
+    // the tail was cut before the index was read, the next reopen succeeds
+    EXPECT_NO_THROW(backend.reopen());
+    EXPECT_TRUE(backend.good());
+
+    for (const std::string &file : {filename, filename + ".1"})
+    {
+        removeLogFiles(file);
+    }
+}
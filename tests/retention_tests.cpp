@@ -0,0 +1,174 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/retention.hpp"
+#include "test_utils.hpp"
+#include <chrono>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using RotatingLogger = zerg::Logger<4096, 8192>;
+
+std::vector<std::string> segmentsOf(const std::filesystem::path &log)
+{
+    std::vector<std::string> names;
+    for (const auto &entry : std::filesystem::directory_iterator(log.parent_path()))
+    {
+        const std::string name = entry.path().filename().string();
+        if (zerg::isRotatedSegment(name, log.filename().string()))
+            names.push_back(name);
+    }
+    std::sort(names.begin(), names.end());
+    return names;
+}
+
+void writeFile(const std::filesystem::path &path, const std::size_t bytes)
+{
+    std::ofstream(path) << std::string(bytes, 'x');
+}
+} // namespace
+
+TEST(RetentionTest, RotationKeepsNewestSegments)
+{
+    const std::filesystem::path dir = "retention_test_rotation";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+    const std::filesystem::path log = dir / "app.log";
+
+    {
+        zerg::FileLogOptions options;
+        options.index = true;
+        options.bloom = true;
+        RotatingLogger logger(log.string(), zerg::Verbosity::DEBUG_LVL,
+                              std::make_unique<zerg::FileLogBackend>(log.string(), options));
+        zerg::RetentionPolicy policy;
+        policy.max_files = 3;
+        logger.setRetention(policy);
+        for (int i = 0; i < 2000; ++i)
+        {
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "record {}", i);
+        }
+        logger.sync();
+    }
+    zerg::RetentionManager::instance().wait();
+
+    const auto segments = segmentsOf(log);
+    EXPECT_EQ(segments.size(), 3u);
+    // the sidecars went with their segments, in both directions
+    EXPECT_TRUE(std::filesystem::exists(dir / (segments.back() + ".idx")));
+    for (const auto &entry : std::filesystem::directory_iterator(dir))
+    {
+        if (entry.path().extension() == ".idx")
+        {
+            EXPECT_TRUE(std::filesystem::exists(entry.path().parent_path() / entry.path().stem()))
+                << entry.path();
+        }
+    }
+    // the newest records survive, the oldest went with the deleted segments
+    std::string kept = readFile(log.string());
+    for (const auto &segment : segments)
+        kept += readFile((dir / segment).string());
+    EXPECT_NE(kept.find("record 1999\n"), std::string::npos);
+    EXPECT_EQ(kept.find("record 0\n"), std::string::npos);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(RetentionTest, EnforcesBytesAndAgeOldestFirst)
+{
+    const std::filesystem::path dir = "retention_test_limits";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+    const std::filesystem::path log = dir / "app.log";
+    writeFile(log, 100);
+
+    const std::int64_t base_ns = 1700000000LL * 1000000000LL;
+    std::vector<std::string> names;
+    for (int i = 0; i < 5; ++i)
+    {
+        const std::string path = zerg::rotatedSegmentPath(log.string(), base_ns + i * 1000000000LL);
+        writeFile(path, 1000);
+        writeFile(path + ".idx", 24);
+        names.push_back(std::filesystem::path(path).filename().string());
+    }
+    writeFile(dir / "app.log.old", 5000); // not a segment name, never touched
+
+    zerg::RetentionPolicy bytes;
+    bytes.max_bytes = 3 * 1024 + 100; // three segments with their sidecars fit
+    zerg::RetentionManager::instance().enforce(log.string(), bytes);
+    zerg::RetentionManager::instance().wait();
+    EXPECT_EQ(segmentsOf(log), std::vector<std::string>(names.begin() + 2, names.end()));
+    EXPECT_FALSE(std::filesystem::exists(dir / (names[0] + ".idx")));
+
+    // one segment rotated long ago by its modification time
+    std::filesystem::last_write_time(dir / names[2], std::filesystem::file_time_type::clock::now() -
+                                                         std::chrono::hours(48));
+    zerg::RetentionPolicy age;
+    age.max_age = std::chrono::hours(24);
+    zerg::RetentionManager::instance().enforce(log.string(), age);
+    zerg::RetentionManager::instance().wait();
+    EXPECT_EQ(segmentsOf(log), std::vector<std::string>(names.begin() + 3, names.end()));
+    EXPECT_TRUE(std::filesystem::exists(log));
+    EXPECT_TRUE(std::filesystem::exists(dir / "app.log.old"));
+    std::filesystem::remove_all(dir);
+}
+
+TEST(RetentionTest, RotationIntoAForeignIndexDegradesInsteadOfTerminating)
+{
+    const std::filesystem::path dir = "retention_test_foreign_index";
+    std::filesystem::remove_all(dir);
+    std::filesystem::create_directory(dir);
+    // too long to take the segment suffix: the rename fails and rotate() reopens the same
+    // file, which runs torn tail recovery on it
+    const std::filesystem::path log = dir / (std::string(240, 'a') + ".log");
+    zerg::FileLogOptions options;
+    options.framing = true;
+
+    RotatingLogger logger(log.string(), zerg::Verbosity::DEBUG_LVL,
+                          std::make_unique<zerg::FileLogBackend>(log.string(), options));
+    // nearly a whole file, the next record rotates before anything follows the torn tail
+    logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "{}", std::string(4000, 'x'));
+    logger.sync();
+    // a torn tail, and an index that is not ours: recovery throws on the backend thread
+    std::ofstream(log, std::ios::app) << "torn record";
+    std::ofstream(zerg::fileIndexPath(log.string())) << "not an index";
+    logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "rotating record");
+    logger.sync();
+    EXPECT_TRUE(logger.degraded());
+
+    // the tail was cut before the index was read: the next probe reopens the file
+    std::this_thread::sleep_for(std::chrono::milliseconds(DEGRADED_PROBE_MIN_MS + 20));
+    logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "after recovery");
+    logger.sync();
+    EXPECT_FALSE(logger.degraded());
+    const std::string content = readFile(log.string());
+    EXPECT_EQ(content.find("torn record"), std::string::npos);
+    EXPECT_NE(content.find("rotating record"), std::string::npos);
+    EXPECT_NE(content.find("backend recovered"), std::string::npos);
+    std::filesystem::remove_all(dir);
+}
+
+TEST(RetentionTest, ThrowingRotateDegradesInsteadOfTerminating)
+{
+    class ThrowingRotateBackend : public zerg::ILogBackend
+    {
+      public:
+        void write(const char *, std::streamsize) override {}
+        void writeNewline() override {}
+        void flush() override {}
+        bool rotate() override { throw std::runtime_error("cannot rotate"); }
+    };
+    RotatingLogger logger("unused", zerg::Verbosity::DEBUG_LVL,
+                          std::make_unique<ThrowingRotateBackend>());
+    for (int i = 0; i < 100; ++i)
+    {
+        logger.log(zerg::Verbosity::WARN_LVL, __FILE__, __LINE__, "rotating record {}", i);
+    }
+    logger.sync();
+    EXPECT_TRUE(logger.degraded());
+}
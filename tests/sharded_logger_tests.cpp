@@ -0,0 +1,168 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/sharded_logger.hpp"
+#include "test_utils.hpp"
+#include <cstdio>
+#include <filesystem>
+#include <fstream>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+TEST(ShardedLoggerTest, ParsesCpuLists)
+{
+    EXPECT_EQ(zerg::parseCpuList("0-3,8,10-11\n"), (std::vector<int>{0, 1, 2, 3, 8, 10, 11}));
+    EXPECT_EQ(zerg::parseCpuList("5"), (std::vector<int>{5}));
+    EXPECT_TRUE(zerg::parseCpuList("").empty());
+}
+
+TEST(ShardedLoggerTest, DetectsNodesFromSysfs)
+{
+    namespace fs = std::filesystem;
+    const fs::path root = "sharded_sysfs_test";
+    fs::remove_all(root);
+    const std::vector<std::pair<std::string, std::string>> nodes = {
+        {"node0", "0-1,4-5"}, {"node1", "2-3,6-7"}, {"node2", ""}};
+    for (const auto &[name, cpus] : nodes)
+    {
+        fs::create_directories(root / name);
+        std::ofstream(root / name / "cpulist") << cpus << "\n";
+    }
+    fs::create_directories(root / "power");
+
+    const auto topology = zerg::NumaTopology::detect(root.string());
+    ASSERT_EQ(topology.nodes.size(), 2u); // node2 has memory only
+    EXPECT_EQ(topology.nodes[1].id, 1);
+    EXPECT_EQ(topology.cpu_to_shard[4], 0);
+    EXPECT_EQ(topology.cpu_to_shard[6], 1);
+    fs::remove_all(root);
+}
+
+TEST(ShardedLoggerTest, WritesOneFilePerNode)
+{
+    const std::string filename = "sharded_test.log";
+    zerg::NumaTopology topology;
+    const unsigned cpus = std::max(1U, std::thread::hardware_concurrency());
+    // split the machine into two fake nodes so both shards get producers
+    topology.nodes = {{0, {}}, {1, {}}};
+    topology.cpu_to_shard.assign(cpus, 0);
+    for (unsigned cpu = 0; cpu < cpus; ++cpu)
+    {
+        const int shard = cpu < (cpus + 1) / 2 ? 0 : 1;
+        topology.nodes[static_cast<std::size_t>(shard)].cpus.push_back(static_cast<int>(cpu));
+        topology.cpu_to_shard[cpu] = shard;
+    }
+    if (topology.nodes[1].cpus.empty())
+        topology.nodes.pop_back();
+
+    {
+        zerg::ShardedLogger<1024 * 1024 * 1024, 1024> logger(filename, zerg::Verbosity::DEBUG_LVL,
+                                                             topology);
+        ASSERT_EQ(logger.shardCount(), topology.nodes.size());
+        for (int i = 0; i < 100; ++i)
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "sharded {}", i);
+        logger.sync();
+    }
+
+    std::size_t lines = 0;
+    for (const auto &node : topology.nodes)
+    {
+        const std::string shard_file = filename + ".node" + std::to_string(node.id);
+        std::ifstream in(shard_file);
+        ASSERT_TRUE(in.is_open()) << shard_file;
+        for (std::string line; std::getline(in, line);)
+        {
+            lines += line.find("sharded ") != std::string::npos ? 1 : 0;
+            // microsecond producer timestamps for zerg-merge, "YYYY-MM-DD HH:MM:SS.ffffff"
+            ASSERT_GT(line.size(), 27u);
+            EXPECT_EQ(line[19], '.') << line;
+            EXPECT_EQ(line.compare(26, 2, " ["), 0) << line;
+        }
+        removeLogFiles(shard_file);
+    }
+    EXPECT_EQ(lines, 100u);
+}
+
+TEST(ShardedLoggerTest, RejectsNodeItCannotBindTo)
+{
+    zerg::NumaTopology topology;
+    // no such cpu: the shard used to be built on an unbound thread
+    topology.nodes = {{0, {CPU_SETSIZE - 1}}};
+    topology.cpu_to_shard.assign(1, 0);
+    EXPECT_THROW((zerg::ShardedLogger<1024 * 1024 * 1024, 1024>("unused_sharded.log",
+                                                                 zerg::Verbosity::DEBUG_LVL,
+                                                                 topology)),
+                 std::runtime_error);
+}
+
+TEST(ShardedLoggerTest, PerThreadFilesWithFineTimestamps)
+{
+    const std::string filename = "per_thread_test.log";
+    constexpr int threads = 4;
+    constexpr int records = 200;
+    {
+        zerg::PerThreadLogger<1024 * 1024 * 1024, 1024> logger(filename);
+        std::vector<std::thread> producers;
+        for (int t = 0; t < threads; ++t)
+        {
+            producers.emplace_back([&logger, t] {
+                for (int i = 0; i < records; ++i)
+                    logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "t{} {}", t, i);
+            });
+        }
+        for (auto &producer : producers)
+            producer.join();
+        EXPECT_EQ(logger.shardCount(), static_cast<std::size_t>(threads));
+        logger.sync();
+    }
+
+    for (int shard = 0; shard < threads; ++shard)
+    {
+        const std::string shard_file = filename + ".t" + std::to_string(shard);
+        std::ifstream in(shard_file);
+        ASSERT_TRUE(in.is_open()) << shard_file;
+        std::vector<std::string> lines;
+        for (std::string line; std::getline(in, line);)
+            lines.push_back(line);
+        ASSERT_EQ(lines.size(), static_cast<std::size_t>(records));
+        for (std::size_t i = 0; i < lines.size(); ++i)
+        {
+            // "YYYY-MM-DD HH:MM:SS.ffffff [INFO] ..."
+            ASSERT_GT(lines[i].size(), 27u);
+            EXPECT_EQ(lines[i][19], '.');
+            EXPECT_EQ(lines[i].compare(26, 2, " ["), 0) << lines[i];
+            if (i > 0)
+            {
+                EXPECT_LE(lines[i - 1].substr(0, 26), lines[i].substr(0, 26));
+            }
+        }
+        removeLogFiles(shard_file);
+    }
+}
+
+TEST(ShardedLoggerTest, ThreadKeepsItsShardAcrossManyLoggers)
+{
+    // more loggers than a thread caches: every one of them still gets a single shard
+    constexpr int loggers = 20;
+    std::vector<std::unique_ptr<zerg::PerThreadLogger<1024 * 1024 * 1024, 1024>>> instances;
+    for (int l = 0; l < loggers; ++l)
+    {
+        instances.push_back(std::make_unique<zerg::PerThreadLogger<1024 * 1024 * 1024, 1024>>(
+            "per_thread_many_test_" + std::to_string(l) + ".log"));
+    }
+    for (int round = 0; round < 3; ++round)
+    {
+        for (auto &instance : instances)
+            instance->log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "round {}", round);
+    }
+    for (auto &instance : instances)
+        EXPECT_EQ(instance->shardCount(), 1u);
+    instances.clear();
+
+    for (int l = 0; l < loggers; ++l)
+    {
+        const std::string shard_file = "per_thread_many_test_" + std::to_string(l) + ".log.t0";
+        EXPECT_NE(readFile(shard_file).find("round 2"), std::string::npos) << shard_file;
+        removeLogFiles(shard_file);
+    }
+}
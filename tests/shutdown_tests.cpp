@@ -0,0 +1,122 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/shutdown.hpp"
+#include "test_utils.hpp"
+#include <atomic>
+#include <chrono>
+#include <cstdio>
+#include <memory>
+#include <string>
+#include <thread>
+#include <vector>
+
+namespace
+{
+using ShutdownLogger = zerg::Logger<1024 * 1024 * 1024, 8192>;
+
+class SlowBackend : public zerg::ILogBackend
+{
+  public:
+    explicit SlowBackend(std::atomic<int> &writes) : _writes(writes) {}
+    void write(const char *, std::streamsize) override
+    {
+        // the first write waits for the test to fill the queue behind it
+        entered = true;
+        while (!open.load())
+        {
+            std::this_thread::yield();
+        }
+        if (slow.load())
+        {
+            std::this_thread::sleep_for(std::chrono::microseconds(200));
+        }
+        ++_writes;
+    }
+    void writeNewline() override {}
+    void flush() override {}
+
+    std::atomic<bool> entered{false};
+    std::atomic<bool> open{true};
+    std::atomic<bool> slow{true};
+
+  private:
+    std::atomic<int> &_writes;
+};
+} // namespace
+
+TEST(ShutdownTest, DrainsAllLoggersAndDestructorsReturnQuickly)
+{
+    std::vector<std::string> files;
+    std::vector<std::unique_ptr<ShutdownLogger>> loggers;
+    for (int i = 0; i < 4; ++i)
+    {
+        files.push_back("shutdown_test_" + std::to_string(i) + ".log");
+        removeLogFiles(files.back());
+        loggers.push_back(std::make_unique<ShutdownLogger>(files.back()));
+        for (int r = 0; r < 1000; ++r)
+        {
+            loggers.back()->log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "record {}", r);
+        }
+    }
+
+    const auto report = zerg::shutdown(std::chrono::seconds(5));
+    EXPECT_GE(report.loggers, 4u);
+    EXPECT_EQ(report.unwritten, 0u);
+    EXPECT_FALSE(report.timed_out);
+    for (const auto &file : files)
+    {
+        const std::string content = readFile(file);
+        EXPECT_NE(content.find("record 0\n"), std::string::npos);
+        EXPECT_NE(content.find("record 999\n"), std::string::npos);
+    }
+
+    // records logged after shutdown are still written, by the destructor
+    loggers.front()->log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "late record");
+    const auto start = std::chrono::steady_clock::now();
+    loggers.clear();
+    // used to take at least 50 ms per logger in sync()
+    EXPECT_LT(std::chrono::steady_clock::now() - start, std::chrono::milliseconds(150));
+    EXPECT_NE(readFile(files.front()).find("late record"), std::string::npos);
+    for (const auto &file : files)
+    {
+        removeLogFiles(file);
+    }
+}
+
+TEST(ShutdownTest, StopsARunningBackendBetweenChunks)
+{
+    std::atomic<int> writes{0};
+    {
+        auto backend = std::make_unique<SlowBackend>(writes);
+        SlowBackend *slow = backend.get();
+        slow->open = false;
+        ShutdownLogger logger("unused", zerg::Verbosity::DEBUG_LVL, std::move(backend));
+
+        // the backend thread takes record 0 alone and blocks in its write, then the other
+        // 4999 as one batch once it is let go
+        logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "record 0");
+        while (!slow->entered.load())
+        {
+            std::this_thread::yield();
+        }
+        for (int r = 1; r < 5000; ++r)
+        {
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "record {}", r);
+        }
+        slow->open = true;
+        while (writes.load() < 10)
+        {
+            std::this_thread::yield();
+        }
+
+        // the whole batch takes about a second, one chunk of it about 200 ms
+        const auto report = zerg::shutdown(std::chrono::milliseconds(50));
+        EXPECT_TRUE(report.timed_out);
+        EXPECT_GT(report.unwritten, 0u);
+        EXPECT_EQ(report.unwritten + static_cast<std::size_t>(writes.load()), 5000u);
+        EXPECT_LT(report.elapsed, std::chrono::milliseconds(500));
+        slow->slow = false;
+    }
+    // the destructor writes the rest of the batch the backend was stopped in
+    EXPECT_EQ(writes.load(), 5000);
+}
@@ -1,6 +1,7 @@
 #ifndef TEST_UTILS_HPP
 #define TEST_UTILS_HPP
 
+#include <cstdio>
 #include <fstream>
 #include <sstream>
 #include <string>
@@ -13,4 +14,13 @@ inline std::string readFile(const std::string &filename)
     return buffer.str();
 }
 
+// a log file and the sidecars a FileLogBackend may keep next to it
+inline void removeLogFiles(const std::string &filename)
+{
+    for (const char *suffix : {"", ".idx", ".bloom"})
+    {
+        std::remove((filename + suffix).c_str());
+    }
+}
+
 #endif // TEST_UTILS_HPP
\ No newline at end of file
@@ -0,0 +1,91 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/backend/file_log_backend.hpp"
+#include "../include/zerg/backend/token_bloom.hpp"
+#include "test_utils.hpp"
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+std::vector<std::string> tokens(const std::string &text)
+{
+    std::vector<std::string> out;
+    zerg::forEachToken(text.data(), text.size(),
+                       [&](const char *t, const std::size_t n) { out.emplace_back(t, n); });
+    return out;
+}
+} // namespace
+
+TEST(TokenBloomTest, SplitsRecordsIntoTokensAndParts)
+{
+    EXPECT_EQ(tokens("[INFO] a.cpp:10 user=42 req-7f"),
+              (std::vector<std::string>{"INFO", "a.cpp:10", "a", "cpp", "10", "user", "42",
+                                        "req-7f"}));
+    EXPECT_TRUE(tokens("  \t ").empty());
+}
+
+TEST(TokenBloomTest, NoFalseNegativesAfterCompactAndExpand)
+{
+    zerg::TokenBloomFilter filter(1 << 16);
+    for (int i = 0; i < 500; ++i)
+    {
+        const std::string record = "request req-" + std::to_string(i) + " served";
+        filter.addTokens(record.data(), record.size());
+    }
+    filter.compact(0.01);
+    EXPECT_LT(filter.bits(), 1u << 16);
+    EXPECT_LE(filter.falsePositiveRate(), 0.01);
+
+    std::size_t false_positives = 0;
+    for (int i = 0; i < 500; ++i)
+    {
+        EXPECT_TRUE(filter.mayContainAll("req-" + std::to_string(i) + " served"));
+        false_positives += filter.mayContainAll("req-x" + std::to_string(i)) ? 1 : 0;
+    }
+    EXPECT_LT(false_positives, 25u);
+
+    filter.expand(1 << 16);
+    EXPECT_EQ(filter.bits(), 1u << 16);
+    for (int i = 0; i < 500; ++i)
+        EXPECT_TRUE(filter.mayContainAll("req-" + std::to_string(i)));
+}
+
+TEST(TokenBloomTest, BackendSavesFilterCoveringTheSegment)
+{
+    const std::string filename = "token_bloom_test.log";
+    removeLogFiles(filename);
+    const zerg::FileLogOptions options{false, INDEX_INTERVAL_BYTES, true, 1 << 16};
+    {
+        zerg::FileLogBackend backend(filename, options);
+        const std::string record = "2025-01-01 10:00:00 [INFO] a.cpp:1 order id-1001 filled";
+        backend.writeRecord(record.data(), static_cast<std::streamsize>(record.size()), {});
+    }
+    {
+        // appending extends the existing filter instead of replacing it
+        zerg::FileLogBackend backend(filename, options);
+        const std::string record = "2025-01-01 10:00:01 [INFO] a.cpp:1 order id-1002 filled";
+        backend.writeRecord(record.data(), static_cast<std::streamsize>(record.size()), {});
+    }
+
+    auto filter = zerg::TokenBloomFilter::load(zerg::tokenBloomPath(filename));
+    std::ifstream in(filename, std::ios::binary | std::ios::ate);
+    EXPECT_EQ(filter.coveredBytes(), static_cast<std::uint64_t>(in.tellg()));
+    EXPECT_TRUE(filter.mayContainAll("id-1001"));
+    EXPECT_TRUE(filter.mayContainAll("id-1002 a.cpp:1"));
+    EXPECT_FALSE(filter.mayContainAll("id-9999"));
+
+    // the log grew behind the filter's back: appending must not save a filter for it
+    std::ofstream(filename, std::ios::app) << "2025-01-01 10:00:02 [INFO] a.cpp:1 id-1003\n";
+    {
+        zerg::FileLogBackend backend(filename, options);
+        const std::string record = "2025-01-01 10:00:03 [INFO] a.cpp:1 id-1004";
+        backend.writeRecord(record.data(), static_cast<std::streamsize>(record.size()), {});
+    }
+    filter = zerg::TokenBloomFilter::load(zerg::tokenBloomPath(filename));
+    std::ifstream again(filename, std::ios::binary | std::ios::ate);
+    EXPECT_NE(filter.coveredBytes(), static_cast<std::uint64_t>(again.tellg()));
+
+    removeLogFiles(filename);
+}
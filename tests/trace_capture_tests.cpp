@@ -0,0 +1,88 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "../include/zerg/trace_capture.hpp"
+#include "test_utils.hpp"
+#include <fstream>
+#include <string>
+#include <thread>
+
+TEST(TraceCaptureTest, RecordsCallsitesAndArgumentShapes)
+{
+    const std::string trace_file = "trace_capture_test.ztrc";
+    {
+        zerg::TraceRecorder recorder(trace_file);
+        const std::string name = "tenant-42";
+        recorder.record(zerg::Verbosity::INFO_LVL, "a.cpp", 10, "user {} id {}", name, 7);
+        recorder.record(zerg::Verbosity::WARN_LVL, "a.cpp", 10, "user {} id {}", name, 8);
+        recorder.record(zerg::Verbosity::ERROR_LVL, "b.cpp", 20, "took {:.2f} ms {} {}", 1.5,
+                        "abc", true);
+        EXPECT_EQ(recorder.recorded(), 3u);
+    }
+
+    const zerg::Trace trace = zerg::readTrace(trace_file);
+    ASSERT_EQ(trace.callsites.size(), 2u);
+    ASSERT_EQ(trace.events.size(), 3u);
+    EXPECT_EQ(trace.threads, 1u);
+
+    EXPECT_EQ(trace.callsites[0].file, "a.cpp");
+    EXPECT_EQ(trace.callsites[0].line, 10);
+    EXPECT_EQ(trace.callsites[0].format, "user {} id {}");
+    EXPECT_EQ(trace.events[1].callsite, 0u);
+    EXPECT_EQ(trace.events[1].level, zerg::Verbosity::WARN_LVL);
+
+    const auto &first = trace.events[0].args;
+    ASSERT_EQ(first.size(), 2u);
+    EXPECT_EQ(first[0].type, zerg::TraceArgType::STRING);
+    EXPECT_EQ(first[0].size, 9u);
+    EXPECT_EQ(first[1].type, zerg::TraceArgType::INT);
+    EXPECT_EQ(first[1].size, sizeof(int));
+
+    const auto &last = trace.events[2].args;
+    ASSERT_EQ(last.size(), 3u);
+    EXPECT_EQ(last[0].type, zerg::TraceArgType::FLOAT);
+    EXPECT_EQ(last[1].type, zerg::TraceArgType::C_STR);
+    EXPECT_EQ(last[1].size, 3u);
+    EXPECT_EQ(last[2].type, zerg::TraceArgType::BOOL);
+
+    EXPECT_LE(trace.events[0].time_ns, trace.events[1].time_ns);
+    EXPECT_LE(trace.events[1].time_ns, trace.events[2].time_ns);
+}
+
+TEST(TraceCaptureTest, LoggerRecordsOnlyAcceptedCallsPerThread)
+{
+    const std::string trace_file = "trace_logger_test.ztrc";
+    {
+        zerg::TraceRecorder recorder(trace_file);
+        zerg::Logger<1024 * 1024> logger("trace_logger_test.log", zerg::Verbosity::INFO_LVL);
+        logger.setTraceRecorder(&recorder);
+
+        logger.log(zerg::Verbosity::DEBUG_LVL, __FILE__, __LINE__, "filtered {}", 1);
+        logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "main {}", 1);
+        std::thread other([&logger] {
+            logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "other {}", 2L);
+        });
+        other.join();
+
+        logger.setTraceRecorder(nullptr);
+        logger.log(zerg::Verbosity::INFO_LVL, __FILE__, __LINE__, "detached");
+        logger.sync();
+    }
+
+    const zerg::Trace trace = zerg::readTrace(trace_file);
+    ASSERT_EQ(trace.events.size(), 2u);
+    EXPECT_EQ(trace.threads, 2u);
+    EXPECT_EQ(trace.callsites[trace.events[1].callsite].format, "other {}");
+    EXPECT_EQ(trace.events[1].args[0].size, sizeof(long));
+    removeLogFiles("trace_logger_test.log");
+}
+
+TEST(TraceCaptureTest, RejectsCorruptTrace)
+{
+    const std::string trace_file = "trace_corrupt_test.ztrc";
+    {
+        std::ofstream out(trace_file, std::ios::binary | std::ios::trunc);
+        out << "ZTRC\x01\x02\x05";
+    }
+    EXPECT_THROW(zerg::readTrace(trace_file), std::runtime_error);
+    EXPECT_THROW(zerg::readTrace("does_not_exist.ztrc"), std::runtime_error);
+}
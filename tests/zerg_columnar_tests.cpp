@@ -0,0 +1,66 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/logger.hpp"
+#include "test_utils.hpp"
+#include <cstdio>
+#include <string>
+
+namespace
+{
+// exit status of zerg-columnar args, -1 if it could not be run; stdout goes to printed
+int columnar(const std::string &args, std::string &printed)
+{
+    FILE *out = ::popen((std::string(ZERG_COLUMNAR_PATH) + " " + args).c_str(), "r");
+    if (out == nullptr)
+        return -1;
+    printed.clear();
+    char buffer[256];
+    for (std::size_t got; (got = std::fread(buffer, 1, sizeof(buffer), out)) > 0;)
+        printed.append(buffer, got);
+    return ::pclose(out);
+}
+} // namespace
+
+TEST(ZergColumnarTest, ColumnQueriesMatchTheText)
+{
+    const std::string filename = "zerg_columnar_test.log";
+    const std::string converted = filename + ".zcol";
+    removeLogFiles(filename);
+    std::remove(converted.c_str());
+    constexpr int requests = 300;
+    {
+        zerg::Logger<1024 * 1024 * 1024, 4096> logger(filename);
+        for (int i = 0; i < requests; ++i)
+        {
+            // distinct counts per level and callsite, so both listings sort the same way
+            const auto level = i % 10 == 0  ? zerg::Verbosity::WARN_LVL
+                               : i % 3 == 0 ? zerg::Verbosity::DEBUG_LVL
+                                            : zerg::Verbosity::INFO_LVL;
+            logger.log(level, __FILE__, __LINE__, "request {} took {} us", i, 3 * i + 7);
+            if (i % 4 == 0)
+                logger.log(zerg::Verbosity::ERROR_LVL, __FILE__, __LINE__, "cache miss {}", i);
+        }
+        logger.waitUntilEmpty();
+    }
+
+    std::string printed;
+    ASSERT_EQ(columnar("convert " + filename + " " + converted, printed), 0);
+    for (const std::string by : {"level", "callsite"})
+    {
+        std::string columns;
+        ASSERT_EQ(columnar("count " + converted + " --by " + by, columns), 0) << by;
+        ASSERT_EQ(columnar("count-text " + filename + " --by " + by, printed), 0) << by;
+        EXPECT_EQ(columns, printed) << by;
+    }
+
+    // template 0 is the first record's, slot 1 its latency
+    ASSERT_EQ(columnar("stats " + converted + " --template 0 --arg 1", printed), 0);
+    EXPECT_NE(printed.find("request {i} took {i} us"), std::string::npos) << printed;
+    EXPECT_NE(printed.find("count " + std::to_string(requests) + " min 7 "), std::string::npos)
+        << printed;
+    EXPECT_NE(printed.find(" max " + std::to_string(3 * (requests - 1) + 7) + " "),
+              std::string::npos)
+        << printed;
+
+    removeLogFiles(filename);
+    std::remove(converted.c_str());
+}
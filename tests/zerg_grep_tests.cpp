@@ -0,0 +1,104 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/backend/file_log_backend.hpp"
+#include "../include/zerg/backend/file_index.hpp"
+#include "test_utils.hpp"
+#include <cstdint>
+#include <cstdio>
+#include <ctime>
+#include <string>
+
+namespace
+{
+constexpr std::int64_t NS_PER_SECOND = 1000000000LL;
+
+std::string localSecond(const std::time_t seconds)
+{
+    std::tm tm_time{};
+    localtime_r(&seconds, &tm_time);
+    char buffer[32];
+    std::strftime(buffer, sizeof(buffer), "%Y-%m-%d %X", &tm_time);
+    return buffer;
+}
+
+void writeSecond(zerg::FileLogBackend &backend, const std::time_t second, const int records,
+                 std::uint64_t &sequence)
+{
+    for (int i = 0; i < records; ++i)
+    {
+        const std::string line = localSecond(second) + " [INFO] record " + std::to_string(i);
+        backend.writeRecord(line.data(), static_cast<std::streamsize>(line.size()),
+                            {second * NS_PER_SECOND + i * 1000000LL, sequence++});
+    }
+}
+
+// lines zerg-grep prints for args, -1 if it could not be run
+int grepLines(const std::string &args)
+{
+    FILE *out = ::popen((std::string(ZERG_GREP_PATH) + " " + args).c_str(), "r");
+    if (out == nullptr)
+        return -1;
+    int lines = 0;
+    for (int c = std::fgetc(out); c != EOF; c = std::fgetc(out))
+    {
+        lines += c == '\n';
+    }
+    return ::pclose(out) == 0 ? lines : -1;
+}
+} // namespace
+
+TEST(ZergGrepTest, WholeSecondToIncludesTheSecond)
+{
+    const std::string filename = "zerg_grep_test.log";
+    removeLogFiles(filename);
+    const std::time_t second = 1738324800;
+    {
+        // an index entry every few records, with nanosecond timestamps inside each second
+        zerg::FileLogOptions options;
+        options.index = true;
+        options.index_interval = 256;
+        zerg::FileLogBackend backend(filename, options);
+        std::uint64_t sequence = 0;
+        for (std::time_t s = second - 1; s <= second + 1; ++s)
+        {
+            writeSecond(backend, s, 1000, sequence);
+        }
+        backend.flush();
+    }
+    ASSERT_GT(zerg::readFileIndex(zerg::fileIndexPath(filename)).size(), 100u);
+
+    const std::string at = std::string("\"").append(localSecond(second)).append("\"");
+    // used to stop at the first index entry of the second
+    EXPECT_EQ(grepLines("--from " + at + " --to " + at + " " + filename), 1000);
+    EXPECT_EQ(grepLines("--to " + at + " " + filename), 2000);
+    removeLogFiles(filename);
+}
+
+TEST(ZergGrepTest, FromIncludesRecordsWrittenBeforeTheIndex)
+{
+    const std::string filename = "zerg_grep_unindexed_test.log";
+    removeLogFiles(filename);
+    const std::time_t second = 1738324800;
+    std::uint64_t sequence = 0;
+    {
+        zerg::FileLogBackend backend(filename);
+        writeSecond(backend, second - 1, 500, sequence);
+        backend.flush();
+    }
+    {
+        // the index starts at the end of the records already in the file
+        zerg::FileLogOptions options;
+        options.index = true;
+        options.index_interval = 256;
+        zerg::FileLogBackend backend(filename, options);
+        writeSecond(backend, second, 500, sequence);
+        backend.flush();
+    }
+    const auto index = zerg::readFileIndex(zerg::fileIndexPath(filename));
+    ASSERT_FALSE(index.empty());
+    ASSERT_GT(index.front().offset, 0u);
+
+    const std::string before = std::string("\"").append(localSecond(second - 1)).append("\"");
+    // used to start at the first index entry and skip the older records
+    EXPECT_EQ(grepLines("--from " + before + " " + filename), 1000);
+    removeLogFiles(filename);
+}
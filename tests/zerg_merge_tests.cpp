@@ -0,0 +1,80 @@
+#include <gtest/gtest.h>
+#include <algorithm>
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <sstream>
+#include <string>
+#include <vector>
+
+namespace
+{
+struct Line
+{
+    long us;
+    std::string text;
+};
+
+// "2025-01-31 12:00:SS.ffffff [INFO] ..." the way PerThreadLogger shards print it
+std::string record(const long us, const std::string &message)
+{
+    char stamp[32];
+    std::snprintf(stamp, sizeof(stamp), "2025-01-31 12:00:%02ld.%06ld", us / 1000000,
+                  us % 1000000);
+    return std::string(stamp) + " [INFO] " + message + "\n";
+}
+
+void writeFile(const std::string &filename, const std::vector<Line> &lines)
+{
+    std::ofstream out(filename, std::ios::out | std::ios::binary | std::ios::trunc);
+    for (const auto &line : lines)
+        out << line.text;
+}
+
+std::string readFile(const std::string &filename)
+{
+    std::ifstream in(filename, std::ios::binary);
+    std::ostringstream content;
+    content << in.rdbuf();
+    return content.str();
+}
+} // namespace
+
+TEST(ZergMergeTest, InterleavesPerThreadFilesByTimestamp)
+{
+    const std::string first = "zerg_merge_test.log.t0";
+    const std::string second = "zerg_merge_test.log.t1";
+    const std::string merged = "zerg_merge_test.log";
+
+    // interleaved across several seconds, every 15 ms both threads log at the same microsecond
+    std::vector<Line> a;
+    std::vector<Line> b;
+    for (long i = 0; i < 1000; ++i)
+    {
+        a.push_back({3000 * i, record(3000 * i, "t0 " + std::to_string(i))});
+        b.push_back({5000 * i, record(5000 * i, "t1 " + std::to_string(i))});
+    }
+    // a multi-line record, its continuation has no timestamp of its own
+    a[10].text += "  continuation of t0 10\n";
+    writeFile(first, a);
+    writeFile(second, b);
+
+    const std::string command =
+        std::string(ZERG_MERGE_PATH) + " -o " + merged + " " + first + " " + second;
+    ASSERT_EQ(std::system(command.c_str()), 0);
+
+    // ties go to the file listed first
+    std::vector<Line> expected = a;
+    expected.insert(expected.end(), b.begin(), b.end());
+    std::stable_sort(expected.begin(), expected.end(),
+                     [](const Line &l, const Line &r) { return l.us < r.us; });
+    std::string text;
+    for (const auto &line : expected)
+        text += line.text;
+
+    const std::string output = readFile(merged);
+    EXPECT_EQ(std::count(output.begin(), output.end(), '\n'), 2001);
+    EXPECT_EQ(output, text);
+    for (const auto &name : {first, second, merged})
+        std::remove(name.c_str());
+}
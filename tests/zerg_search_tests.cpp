@@ -0,0 +1,102 @@
+#include <gtest/gtest.h>
+#include "../include/zerg/backend/file_log_backend.hpp"
+#include "../include/zerg/backend/token_bloom.hpp"
+#include "test_utils.hpp"
+#include <cstdio>
+#include <fstream>
+#include <iterator>
+#include <string>
+#include <sys/wait.h>
+#include <vector>
+
+namespace
+{
+void writeSegment(const std::string &filename, const std::string &request, const bool bloom)
+{
+    removeLogFiles(filename);
+    zerg::FileLogOptions options;
+    options.bloom = bloom;
+    zerg::FileLogBackend backend(filename, options);
+    for (std::uint64_t i = 0; i < 500; ++i)
+    {
+        const std::string line = "2025-01-31 12:00:00 [INFO] handled " + request + " step " +
+                                 std::to_string(i);
+        backend.writeRecord(line.data(), static_cast<std::streamsize>(line.size()), {0, i});
+    }
+    // the filter is saved when the segment is closed
+}
+
+// exit status of zerg-search -v args, -1 if it could not be run; stdout goes to printed and
+// the -v statistics to summary
+int search(const std::string &args, std::string &printed, std::string &summary)
+{
+    const std::string errors = "zerg_search_test.err";
+    FILE *out = ::popen((std::string(ZERG_SEARCH_PATH) + " -v " + args + " 2>" + errors).c_str(),
+                        "r");
+    if (out == nullptr)
+        return -1;
+    printed.clear();
+    char buffer[256];
+    for (std::size_t got; (got = std::fread(buffer, 1, sizeof(buffer), out)) > 0;)
+        printed.append(buffer, got);
+    const int status = ::pclose(out);
+    std::ifstream in(errors);
+    summary.assign(std::istreambuf_iterator<char>(in), std::istreambuf_iterator<char>());
+    std::remove(errors.c_str());
+    return status;
+}
+
+int countOf(const std::string &text, const std::string &needle)
+{
+    int count = 0;
+    for (auto at = text.find(needle); at != std::string::npos; at = text.find(needle, at + 1))
+        ++count;
+    return count;
+}
+} // namespace
+
+TEST(ZergSearchTest, SkipsSegmentsTheirFilterRulesOut)
+{
+    // a filter each, one of them stale and one segment without any
+    const std::vector<std::string> segments = {"zerg_search_test.log.1", "zerg_search_test.log.2",
+                                               "zerg_search_test.log.3", "zerg_search_test.log.4"};
+    writeSegment(segments[0], "req-aaaa", true);
+    writeSegment(segments[1], "req-bbbb", true);
+    writeSegment(segments[2], "req-cccc", true);
+    writeSegment(segments[3], "req-bbbb", false);
+    ASSERT_TRUE(std::ifstream(zerg::tokenBloomPath(segments[0])).good());
+    {
+        // grew after its filter was saved, the filter no longer covers it
+        std::ofstream stale(segments[2], std::ios::app);
+        stale << "2025-01-31 12:00:01 [INFO] handled req-bbbb late\n";
+    }
+
+    std::string args;
+    for (const auto &segment : segments)
+        args += " " + segment;
+
+    std::string printed;
+    std::string summary;
+    ASSERT_EQ(search("req-bbbb" + args, printed, summary), 0);
+    // only the first segment is ruled out, the stale and unfiltered ones are scanned
+    EXPECT_NE(summary.find("1 of 4 segments skipped by their filter, 1001 lines matched"),
+              std::string::npos)
+        << summary;
+    EXPECT_EQ(countOf(printed, segments[1] + ":"), 500);
+    EXPECT_EQ(countOf(printed, segments[2] + ":"), 1);
+    EXPECT_EQ(countOf(printed, segments[3] + ":"), 500);
+    EXPECT_EQ(printed.find(segments[0] + ":"), std::string::npos);
+
+    // both tokens must be in one record, a filter holding only one of them still skips
+    ASSERT_EQ(search("\"req-aaaa step\"" + args, printed, summary), 0);
+    EXPECT_NE(summary.find("1 of 4 segments skipped by their filter, 500 lines matched"),
+              std::string::npos)
+        << summary;
+
+    // grep convention, 1 = nothing found
+    EXPECT_EQ(WEXITSTATUS(search("req-dddd" + args, printed, summary)), 1);
+    EXPECT_NE(summary.find("2 of 4 segments skipped"), std::string::npos) << summary;
+
+    for (const auto &segment : segments)
+        removeLogFiles(segment);
+}
@@ -0,0 +1,64 @@
+#include <gtest/gtest.h>
+#include <chrono>
+#include <cstdio>
+#include <fstream>
+#include <string>
+#include <thread>
+#include <unistd.h>
+
+namespace
+{
+// long enough for zerg-tail to pick up each step through inotify before the next one
+constexpr auto SETTLE = std::chrono::milliseconds(300);
+
+void writeFile(const std::string &filename, const std::string &content,
+               const std::ios::openmode mode = std::ios::trunc)
+{
+    std::ofstream out(filename, std::ios::out | std::ios::binary | mode);
+    out << content;
+}
+} // namespace
+
+TEST(ZergTailTest, FollowsTruncationAndRotationWithoutTornRecords)
+{
+    const std::string filename = "zerg_tail_test.log";
+    const std::string rotated = filename + ".1";
+    const std::string gone = filename + ".2";
+    for (const auto &name : {filename, rotated, gone})
+        std::remove(name.c_str());
+
+    writeFile(filename, "first record\n");
+    // -q: exits once the file is renamed away and not replaced
+    FILE *out = ::popen((std::string(ZERG_TAIL_PATH) + " -q " + filename).c_str(), "r");
+    ASSERT_NE(out, nullptr);
+    std::this_thread::sleep_for(SETTLE);
+
+    // copytruncate: shorter than what was read so far, followed from the start
+    writeFile(filename, "r2\n");
+    std::this_thread::sleep_for(SETTLE);
+
+    // a record the writer never finished before the file was rotated
+    writeFile(filename, "torn-partial", std::ios::app);
+    std::this_thread::sleep_for(SETTLE);
+
+    // rename rotation, the path always names a file
+    writeFile(filename + ".new", "r3\n");
+    ASSERT_EQ(::link(filename.c_str(), rotated.c_str()), 0);
+    ASSERT_EQ(std::rename((filename + ".new").c_str(), filename.c_str()), 0);
+    std::this_thread::sleep_for(SETTLE);
+
+    writeFile(filename, "r4\n", std::ios::app);
+    std::this_thread::sleep_for(SETTLE);
+    ASSERT_EQ(std::rename(filename.c_str(), gone.c_str()), 0);
+
+    std::string printed;
+    char buffer[256];
+    for (std::size_t got; (got = std::fread(buffer, 1, sizeof(buffer), out)) > 0;)
+        printed.append(buffer, got);
+    EXPECT_EQ(::pclose(out), 0);
+
+    // used to print the unterminated tail as a record of its own
+    EXPECT_EQ(printed, "first record\nr2\nr3\nr4\n");
+    for (const auto &name : {filename, rotated, gone})
+        std::remove(name.c_str());
+}
@@ -0,0 +1,200 @@
+#!/usr/bin/env python3
+"""Compare zerg benchmark runs against a stored baseline.
+
+Runs the google-benchmark executable with JSON output and repetitions, reduces every
+benchmark to median and MAD (median absolute deviation) and flags a regression only
+when the slowdown is above the relative threshold *and* outside the noise band of both
+runs. Exits 1 when any benchmark regressed so it can gate CI or an upgrade.
+
+  bench_compare.py run      --benchmark ./benchmarks --out current.json
+  bench_compare.py compare  baseline.json current.json
+  bench_compare.py check    --benchmark ./benchmarks --baseline baseline.json
+"""
+
+import argparse
+import json
+import os
+import statistics
+import subprocess
+import sys
+import tempfile
+
+# scale factor making MAD a consistent estimator of the standard deviation
+MAD_SCALE = 1.4826
+
+TO_NS = {"ns": 1.0, "us": 1e3, "ms": 1e6, "s": 1e9}
+
+
+def run_benchmarks(executable, out, repetitions, filter_regex, min_time):
+    cmd = [
+        executable,
+        "--benchmark_out=" + out,
+        "--benchmark_out_format=json",
+        "--benchmark_repetitions=%d" % repetitions,
+        "--benchmark_report_aggregates_only=false",
+        "--benchmark_display_aggregates_only=true",
+    ]
+    if filter_regex:
+        cmd.append("--benchmark_filter=" + filter_regex)
+    if min_time:
+        cmd.append("--benchmark_min_time=%s" % min_time)
+    print("running:", " ".join(cmd), file=sys.stderr)
+    subprocess.run(cmd, check=True, stdout=sys.stderr)
+
+
+def load_samples(path, metric):
+    """Return {run_name: [value, ...]} with one value per repetition."""
+    with open(path) as f:
+        data = json.load(f)
+    samples = {}
+    for bench in data.get("benchmarks", []):
+        if bench.get("run_type", "iteration") != "iteration":
+            continue
+        if "error_occurred" in bench and bench["error_occurred"]:
+            continue
+        name = bench.get("run_name", bench["name"])
+        if metric in ("real_time", "cpu_time"):
+            value = bench[metric] * TO_NS[bench.get("time_unit", "ns")]
+        elif metric in bench:
+            value = float(bench[metric])
+        else:
+            continue
+        samples.setdefault(name, []).append(value)
+    return samples
+
+
+def median_mad(values):
+    med = statistics.median(values)
+    mad = statistics.median([abs(v - med) for v in values]) * MAD_SCALE
+    return med, mad
+
+
+def compare(baseline, current, threshold, noise_k):
+    """Return (rows, regressions) for a table of baseline vs current medians."""
+    rows = []
+    regressions = 0
+    for name in sorted(set(baseline) | set(current)):
+        if name not in baseline:
+            rows.append((name, None, None, *median_mad(current[name]), None, "new"))
+            continue
+        if name not in current:
+            rows.append((name, *median_mad(baseline[name]), None, None, None, "missing"))
+            continue
+        base_med, base_mad = median_mad(baseline[name])
+        cur_med, cur_mad = median_mad(current[name])
+        delta = (cur_med - base_med) / base_med if base_med else 0.0
+        noise = noise_k * max(base_mad, cur_mad)
+        status = "ok"
+        if abs(cur_med - base_med) > noise and abs(delta) > threshold:
+            if delta > 0:
+                status = "REGRESSION"
+                regressions += 1
+            else:
+                status = "improved"
+        elif abs(delta) > threshold:
+            status = "noisy"
+        rows.append((name, base_med, base_mad, cur_med, cur_mad, delta, status))
+    return rows, regressions
+
+
+def fmt(value, unit):
+    if value is None:
+        return "-"
+    return "%.2f%s" % (value, unit)
+
+
+def print_table(rows, metric):
+    unit = " ns" if metric in ("real_time", "cpu_time") else ""
+    header = ("benchmark", "baseline", "+-", "current", "+-", "delta", "status")
+    table = [header]
+    for name, base_med, base_mad, cur_med, cur_mad, delta, status in rows:
+        table.append((name, fmt(base_med, unit), fmt(base_mad, unit), fmt(cur_med, unit),
+                      fmt(cur_mad, unit), "-" if delta is None else "%+.1f%%" % (delta * 100),
+                      status))
+    widths = [max(len(row[i]) for row in table) for i in range(len(header))]
+    for i, row in enumerate(table):
+        print("  ".join(cell.ljust(widths[c]) if c == 0 else cell.rjust(widths[c])
+                        for c, cell in enumerate(row)))
+        if i == 0:
+            print("  ".join("-" * w for w in widths))
+
+
+def add_compare_args(parser):
+    parser.add_argument("--metric", default="real_time",
+                        help="real_time, cpu_time or a user counter name (default real_time)")
+    parser.add_argument("--threshold", type=float, default=0.05,
+                        help="minimum relative slowdown to report (default 0.05 = 5%%)")
+    parser.add_argument("--noise", type=float, default=3.0,
+                        help="slowdown must also exceed NOISE x MAD (default 3)")
+
+
+def add_run_args(parser):
+    parser.add_argument("--benchmark", required=True, help="benchmark executable")
+    parser.add_argument("--repetitions", type=int, default=10)
+    parser.add_argument("--filter", default="", help="--benchmark_filter regex")
+    parser.add_argument("--min-time", default="", help="--benchmark_min_time per repetition")
+
+
+def report(baseline_path, current_path, args):
+    baseline = load_samples(baseline_path, args.metric)
+    current = load_samples(current_path, args.metric)
+    if not baseline:
+        print("no samples for %s in %s" % (args.metric, baseline_path), file=sys.stderr)
+        return 2
+    rows, regressions = compare(baseline, current, args.threshold, args.noise)
+    print_table(rows, args.metric)
+    if regressions:
+        print("\n%d benchmark(s) regressed by more than %.1f%%" %
+              (regressions, args.threshold * 100))
+        return 1
+    print("\nno regressions")
+    return 0
+
+
+def main():
+    parser = argparse.ArgumentParser(description=__doc__,
+                                     formatter_class=argparse.RawDescriptionHelpFormatter)
+    sub = parser.add_subparsers(dest="command", required=True)
+
+    run = sub.add_parser("run", help="run the benchmarks and store JSON results")
+    add_run_args(run)
+    run.add_argument("--out", required=True)
+
+    cmp = sub.add_parser("compare", help="compare two stored JSON results")
+    cmp.add_argument("baseline")
+    cmp.add_argument("current")
+    add_compare_args(cmp)
+
+    check = sub.add_parser("check", help="run the benchmarks and compare to a baseline")
+    add_run_args(check)
+    check.add_argument("--baseline", required=True)
+    check.add_argument("--out", default="", help="also keep the current results here")
+    add_compare_args(check)
+
+    args = parser.parse_args()
+
+    if args.command == "run":
+        run_benchmarks(args.benchmark, args.out, args.repetitions, args.filter, args.min_time)
+        return 0
+
+    if args.command == "compare":
+        return report(args.baseline, args.current, args)
+
+    if not os.path.exists(args.baseline):
+        print("baseline %s does not exist, record one with the bench-baseline target" %
+              args.baseline, file=sys.stderr)
+        return 2
+    out = args.out
+    if not out:
+        fd, out = tempfile.mkstemp(suffix=".json")
+        os.close(fd)
+    try:
+        run_benchmarks(args.benchmark, out, args.repetitions, args.filter, args.min_time)
+        return report(args.baseline, out, args)
+    finally:
+        if not args.out:
+            os.unlink(out)
+
+
+if __name__ == "__main__":
+    sys.exit(main())
@@ -0,0 +1,831 @@
+// zerg-columnar: convert zerg text logs into a columnar file and aggregate over it
+//
+//   zerg-columnar convert app.log [app.log.zcol]     one columnar file per log segment
+//   zerg-columnar schema  app.log.zcol               templates, columns and their sizes
+//   zerg-columnar count   app.log.zcol --by level|callsite|template
+//   zerg-columnar stats   app.log.zcol --template N --arg K
+//   zerg-columnar count-text app.log --by ...        same count parsing the text, to compare
+//
+// Every record is split into row columns (timestamp, level, callsite, template and, when the
+// logger printed them, sequence / thread / thread_sequence) and a message template: numbers
+// and ids in the message become typed argument slots ({i} int, {f} float, {s} string) and
+// the remaining text is the template. Each (template, slot) is its own column holding only
+// the rows of that template, so "latency of callsite X" reads one small column.
+//
+// Encodings: timestamps, sequences and int slots are delta + zigzag varints, level is run
+// length encoded, callsite / template ids are varints into a dictionary, string slots are
+// dictionary encoded per column, float slots are raw doubles. A query reads the header and
+// only the columns it needs. -v prints timings.
+
+#include "../include/zerg/backend/log_timestamp.hpp"
+
+#include <algorithm>
+#include <chrono>
+#include <cstdint>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fstream>
+#include <iterator>
+#include <map>
+#include <stdexcept>
+#include <string>
+#include <unordered_map>
+#include <utility>
+#include <vector>
+
+namespace
+{
+constexpr char MAGIC[4] = {'Z', 'C', 'O', 'L'};
+constexpr std::uint32_t VERSION = 1;
+constexpr std::uint8_t NO_LEVEL = 255; // lines that are not records (continuations)
+
+const char *const LEVELS[] = {"DEBUG", "INFO", "WARN", "ERROR", "FATAL"};
+
+enum class Encoding : std::uint8_t
+{
+    DELTA_VARINT = 1,
+    RLE_U8 = 2,
+    VARINT = 3,
+    FLOAT64 = 4,
+    DICT_STRING = 5,
+};
+
+// ---- varints --------------------------------------------------------------------------
+
+void putVarint(std::string &out, std::uint64_t value)
+{
+    while (value >= 0x80)
+    {
+        out.push_back(static_cast<char>((value & 0x7f) | 0x80));
+        value >>= 7;
+    }
+    out.push_back(static_cast<char>(value));
+}
+
+std::uint64_t zigzag(const std::int64_t value)
+{
+    return (static_cast<std::uint64_t>(value) << 1) ^ static_cast<std::uint64_t>(value >> 63);
+}
+
+std::int64_t unzigzag(const std::uint64_t value)
+{
+    return static_cast<std::int64_t>(value >> 1) ^ -static_cast<std::int64_t>(value & 1);
+}
+
+void putString(std::string &out, const std::string &value)
+{
+    putVarint(out, value.size());
+    out += value;
+}
+
+class Reader
+{
+  public:
+    Reader(const char *data, const std::size_t size) : _data(data), _end(data + size) {}
+
+    std::uint64_t varint()
+    {
+        std::uint64_t value = 0;
+        for (unsigned shift = 0; shift < 64; shift += 7)
+        {
+            if (_data == _end)
+                throw std::runtime_error("truncated column file");
+            const auto byte = static_cast<std::uint8_t>(*_data++);
+            value |= static_cast<std::uint64_t>(byte & 0x7f) << shift;
+            if ((byte & 0x80) == 0)
+                return value;
+        }
+        throw std::runtime_error("bad varint");
+    }
+
+    std::string string()
+    {
+        const auto size = static_cast<std::size_t>(varint());
+        if (static_cast<std::size_t>(_end - _data) < size)
+            throw std::runtime_error("truncated column file");
+        std::string value(_data, size);
+        _data += size;
+        return value;
+    }
+
+    std::uint8_t byte()
+    {
+        if (_data == _end)
+            throw std::runtime_error("truncated column file");
+        return static_cast<std::uint8_t>(*_data++);
+    }
+
+    double float64()
+    {
+        double value;
+        if (static_cast<std::size_t>(_end - _data) < sizeof(value))
+            throw std::runtime_error("truncated column file");
+        std::memcpy(&value, _data, sizeof(value));
+        _data += sizeof(value);
+        return value;
+    }
+
+  private:
+    const char *_data;
+    const char *_end;
+};
+
+// ---- text parsing ---------------------------------------------------------------------
+
+bool isDigits(const std::string &text, std::size_t from, const std::size_t to)
+{
+    if (from == to)
+        return false;
+    for (; from < to; ++from)
+    {
+        if (text[from] < '0' || text[from] > '9')
+            return false;
+    }
+    return true;
+}
+
+struct Record
+{
+    std::int64_t timestamp{};
+    std::uint8_t level{NO_LEVEL};
+    bool has_sequence{};
+    std::int64_t sequence{};
+    bool has_thread{};
+    std::int64_t thread{};
+    std::int64_t thread_sequence{};
+    std::string callsite;
+    std::string message;
+};
+
+// "TIME [LEVEL] (#seq )(tN:M )file:line message"
+bool parseRecord(const std::string &line, Record &record)
+{
+    // records of the same second share one mktime
+    static zerg::LogTimestampParser parser;
+    std::size_t pos = 0;
+    const std::int64_t ts = parser.parse(line.data(), line.size(), pos);
+    if (ts < 0 || line.compare(pos, 2, " [") != 0)
+        return false;
+    const auto close = line.find("] ", pos);
+    if (close == std::string::npos)
+        return false;
+    record.timestamp = ts;
+    record.level = NO_LEVEL;
+    const std::string level = line.substr(pos + 2, close - pos - 2);
+    for (std::uint8_t i = 0; i < 5; ++i)
+    {
+        if (level == LEVELS[i])
+            record.level = i;
+    }
+    pos = close + 2;
+
+    record.has_sequence = false;
+    record.has_thread = false;
+    auto token_end = line.find(' ', pos);
+    if (token_end != std::string::npos && line[pos] == '#' && isDigits(line, pos + 1, token_end))
+    {
+        record.has_sequence = true;
+        record.sequence = std::strtoll(line.c_str() + pos + 1, nullptr, 10);
+        pos = token_end + 1;
+        token_end = line.find(' ', pos);
+    }
+    if (token_end != std::string::npos && line[pos] == 't')
+    {
+        const auto colon = line.find(':', pos);
+        if (colon < token_end && isDigits(line, pos + 1, colon) &&
+            isDigits(line, colon + 1, token_end))
+        {
+            record.has_thread = true;
+            record.thread = std::strtoll(line.c_str() + pos + 1, nullptr, 10);
+            record.thread_sequence = std::strtoll(line.c_str() + colon + 1, nullptr, 10);
+            pos = token_end + 1;
+            token_end = line.find(' ', pos);
+        }
+    }
+    if (token_end == std::string::npos)
+        token_end = line.size();
+    record.callsite.assign(line, pos, token_end - pos);
+    record.message.assign(line, std::min(line.size(), token_end + 1), std::string::npos);
+    return true;
+}
+
+enum class SlotType : char
+{
+    INT = 'i',
+    FLOAT = 'f',
+    STRING = 's',
+};
+
+struct Slot
+{
+    SlotType type;
+    std::string text;
+};
+
+bool isSeparator(const char c)
+{
+    return c == ' ' || c == '\t' || c == ',' || c == ';' || c == '(' || c == ')' || c == '[' ||
+           c == ']' || c == '{' || c == '}' || c == '=' || c == '"' || c == '\'' || c == '<' ||
+           c == '>' || c == '|';
+}
+
+// numbers and ids become typed slots, everything else is template text
+std::string extractTemplate(const std::string &message, std::vector<Slot> &slots)
+{
+    std::string pattern;
+    slots.clear();
+    std::size_t i = 0;
+    while (i < message.size())
+    {
+        if (isSeparator(message[i]))
+        {
+            pattern.push_back(message[i++]);
+            continue;
+        }
+        const std::size_t start = i;
+        bool digit = false;
+        for (; i < message.size() && !isSeparator(message[i]); ++i)
+            digit |= message[i] >= '0' && message[i] <= '9';
+        // a trailing ':' or '.' is punctuation, not part of the value
+        std::size_t end = i;
+        while (end > start + 1 && (message[end - 1] == ':' || message[end - 1] == '.'))
+            --end;
+        if (!digit)
+        {
+            pattern.append(message, start, i - start);
+            continue;
+        }
+
+        const std::string token = message.substr(start, end - start);
+        char *parsed_end = nullptr;
+        SlotType type = SlotType::STRING;
+        std::strtoll(token.c_str(), &parsed_end, 10);
+        if (*parsed_end == '\0' && token.size() < 19)
+            type = SlotType::INT;
+        else
+        {
+            std::strtod(token.c_str(), &parsed_end);
+            if (*parsed_end == '\0' && token.find_first_of("xXnN") == std::string::npos)
+                type = SlotType::FLOAT;
+        }
+        slots.push_back({type, token});
+        pattern += '{';
+        pattern += static_cast<char>(type);
+        pattern += '}';
+        pattern.append(message, end, i - end);
+    }
+    return pattern;
+}
+
+// ---- column building ------------------------------------------------------------------
+
+struct ColumnBuilder
+{
+    ColumnBuilder(std::string column_name, const Encoding column_encoding)
+        : name(std::move(column_name)), encoding(column_encoding)
+    {
+    }
+
+    std::string name;
+    Encoding encoding;
+    std::uint64_t rows{};
+    std::string data;
+    std::int64_t previous{};
+    // RLE_U8
+    std::uint8_t run_value{};
+    std::uint64_t run_length{};
+    // DICT_STRING
+    std::unordered_map<std::string, std::uint64_t> dictionary;
+    std::vector<const std::string *> words;
+    std::string ids;
+
+    void addInt(const std::int64_t value)
+    {
+        putVarint(data, zigzag(value - previous));
+        previous = value;
+        ++rows;
+    }
+
+    void addVarint(const std::uint64_t value)
+    {
+        putVarint(data, value);
+        ++rows;
+    }
+
+    void addLevel(const std::uint8_t value)
+    {
+        if (run_length > 0 && value != run_value)
+            flushRun();
+        run_value = value;
+        ++run_length;
+        ++rows;
+    }
+
+    void addFloat(const double value)
+    {
+        data.append(reinterpret_cast<const char *>(&value), sizeof(value));
+        ++rows;
+    }
+
+    void addString(const std::string &value)
+    {
+        auto [it, inserted] = dictionary.emplace(value, dictionary.size());
+        if (inserted)
+            words.push_back(&it->first);
+        putVarint(ids, it->second);
+        ++rows;
+    }
+
+    void flushRun()
+    {
+        data.push_back(static_cast<char>(run_value));
+        putVarint(data, run_length);
+        run_length = 0;
+    }
+
+    std::string finish()
+    {
+        if (encoding == Encoding::RLE_U8 && run_length > 0)
+            flushRun();
+        if (encoding == Encoding::DICT_STRING)
+        {
+            std::string out;
+            putVarint(out, words.size());
+            for (const auto *word : words)
+                putString(out, *word);
+            return out + ids;
+        }
+        return std::move(data);
+    }
+};
+
+struct Dictionary
+{
+    std::unordered_map<std::string, std::uint64_t> ids;
+    std::vector<std::string> values;
+
+    std::uint64_t id(const std::string &value)
+    {
+        auto [it, inserted] = ids.emplace(value, values.size());
+        if (inserted)
+            values.push_back(value);
+        return it->second;
+    }
+};
+
+int convert(const std::string &input, const std::string &output, const bool verbose)
+{
+    const auto start = std::chrono::steady_clock::now();
+    std::ifstream in(input);
+    if (!in)
+    {
+        std::fprintf(stderr, "zerg-columnar: cannot open %s\n", input.c_str());
+        return 2;
+    }
+
+    Dictionary callsites;
+    Dictionary templates;
+    ColumnBuilder timestamp{"timestamp", Encoding::DELTA_VARINT};
+    ColumnBuilder level{"level", Encoding::RLE_U8};
+    ColumnBuilder callsite{"callsite", Encoding::VARINT};
+    ColumnBuilder pattern{"template", Encoding::VARINT};
+    ColumnBuilder sequence{"sequence", Encoding::DELTA_VARINT};
+    ColumnBuilder thread{"thread", Encoding::VARINT};
+    ColumnBuilder thread_sequence{"thread_sequence", Encoding::DELTA_VARINT};
+    // template id -> one column per slot, created with the template
+    std::vector<std::vector<ColumnBuilder>> slot_columns;
+
+    Record record;
+    std::vector<Slot> slots;
+    std::uint64_t rows = 0;
+    std::uint64_t input_bytes = 0;
+    for (std::string line; std::getline(in, line);)
+    {
+        input_bytes += line.size() + 1;
+        if (!parseRecord(line, record))
+        {
+            // continuation: a row of its own with the previous timestamp and no level
+            record.level = NO_LEVEL;
+            record.callsite.clear();
+            record.message = line;
+            record.has_sequence = record.has_thread = false;
+        }
+        const std::string text = extractTemplate(record.message, slots);
+        const std::uint64_t template_id = templates.id(text);
+        if (template_id == slot_columns.size())
+        {
+            slot_columns.emplace_back();
+            for (std::size_t k = 0; k < slots.size(); ++k)
+            {
+                const std::string name = "t" + std::to_string(template_id) + "." +
+                                         std::to_string(k);
+                const Encoding encoding = slots[k].type == SlotType::INT
+                                              ? Encoding::DELTA_VARINT
+                                              : slots[k].type == SlotType::FLOAT
+                                                    ? Encoding::FLOAT64
+                                                    : Encoding::DICT_STRING;
+                slot_columns.back().emplace_back(name, encoding);
+            }
+        }
+
+        timestamp.addInt(record.timestamp);
+        level.addLevel(record.level);
+        callsite.addVarint(callsites.id(record.callsite));
+        pattern.addVarint(template_id);
+        if (record.has_sequence || sequence.rows > 0)
+        {
+            // once seen the column has a value per row, gaps before it are back filled
+            while (sequence.rows < rows)
+                sequence.addInt(sequence.previous);
+            sequence.addInt(record.has_sequence ? record.sequence : sequence.previous);
+        }
+        if (record.has_thread || thread.rows > 0)
+        {
+            while (thread.rows < rows)
+            {
+                thread.addVarint(0);
+                thread_sequence.addInt(thread_sequence.previous);
+            }
+            thread.addVarint(record.has_thread ? static_cast<std::uint64_t>(record.thread) : 0);
+            thread_sequence.addInt(record.has_thread ? record.thread_sequence
+                                                     : thread_sequence.previous);
+        }
+        auto &columns = slot_columns[template_id];
+        for (std::size_t k = 0; k < slots.size(); ++k)
+        {
+            if (slots[k].type == SlotType::INT)
+                columns[k].addInt(std::strtoll(slots[k].text.c_str(), nullptr, 10));
+            else if (slots[k].type == SlotType::FLOAT)
+                columns[k].addFloat(std::strtod(slots[k].text.c_str(), nullptr));
+            else
+                columns[k].addString(slots[k].text);
+        }
+        ++rows;
+    }
+
+    std::vector<ColumnBuilder *> columns = {&timestamp, &level, &callsite, &pattern};
+    if (sequence.rows > 0)
+        columns.push_back(&sequence);
+    if (thread.rows > 0)
+    {
+        columns.push_back(&thread);
+        columns.push_back(&thread_sequence);
+    }
+    for (auto &per_template : slot_columns)
+    {
+        for (auto &column : per_template)
+            columns.push_back(&column);
+    }
+
+    std::string header;
+    header.append(MAGIC, sizeof(MAGIC));
+    header.append(reinterpret_cast<const char *>(&VERSION), sizeof(VERSION));
+    putVarint(header, rows);
+    putVarint(header, callsites.values.size());
+    for (const auto &value : callsites.values)
+        putString(header, value);
+    putVarint(header, templates.values.size());
+    for (const auto &value : templates.values)
+        putString(header, value);
+
+    std::vector<std::string> blobs;
+    putVarint(header, columns.size());
+    std::uint64_t offset = 0;
+    for (auto *column : columns)
+    {
+        blobs.push_back(column->finish());
+        putString(header, column->name);
+        header.push_back(static_cast<char>(column->encoding));
+        putVarint(header, column->rows);
+        putVarint(header, offset);
+        putVarint(header, blobs.back().size());
+        offset += blobs.back().size();
+    }
+
+    std::ofstream out(output, std::ios::binary | std::ios::trunc);
+    const auto header_size = static_cast<std::uint64_t>(header.size());
+    out.write(reinterpret_cast<const char *>(&header_size), sizeof(header_size));
+    out << header;
+    for (const auto &blob : blobs)
+        out << blob;
+    if (!out)
+    {
+        std::fprintf(stderr, "zerg-columnar: cannot write %s\n", output.c_str());
+        return 2;
+    }
+
+    if (verbose)
+    {
+        const double seconds =
+            std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+        std::fprintf(stderr, "%llu rows, %zu templates, %zu columns, %llu -> %llu bytes, %.2fs\n",
+                     static_cast<unsigned long long>(rows), templates.values.size(),
+                     columns.size(), static_cast<unsigned long long>(input_bytes),
+                     static_cast<unsigned long long>(sizeof(header_size) + header_size + offset),
+                     seconds);
+    }
+    return 0;
+}
+
+// ---- reading --------------------------------------------------------------------------
+
+struct ColumnInfo
+{
+    std::string name;
+    Encoding encoding;
+    std::uint64_t rows;
+    std::uint64_t offset;
+    std::uint64_t size;
+};
+
+class ColumnFile
+{
+  public:
+    explicit ColumnFile(const std::string &path) : _in(path, std::ios::binary)
+    {
+        std::uint64_t header_size = 0;
+        if (!_in.read(reinterpret_cast<char *>(&header_size), sizeof(header_size)) ||
+            header_size > (1ULL << 32))
+            throw std::runtime_error("not a zerg column file: " + path);
+        std::string header(static_cast<std::size_t>(header_size), '\0');
+        if (!_in.read(&header[0], static_cast<std::streamsize>(header.size())) ||
+            header.compare(0, sizeof(MAGIC), MAGIC, sizeof(MAGIC)) != 0)
+            throw std::runtime_error("not a zerg column file: " + path);
+        std::uint32_t version;
+        std::memcpy(&version, header.data() + sizeof(MAGIC), sizeof(version));
+        if (version != VERSION)
+            throw std::runtime_error("unsupported column file version: " + path);
+
+        Reader reader(header.data() + sizeof(MAGIC) + sizeof(version),
+                      header.size() - sizeof(MAGIC) - sizeof(version));
+        rows = reader.varint();
+        callsites.resize(static_cast<std::size_t>(reader.varint()));
+        for (auto &value : callsites)
+            value = reader.string();
+        templates.resize(static_cast<std::size_t>(reader.varint()));
+        for (auto &value : templates)
+            value = reader.string();
+        columns.resize(static_cast<std::size_t>(reader.varint()));
+        for (auto &column : columns)
+        {
+            column.name = reader.string();
+            column.encoding = static_cast<Encoding>(reader.byte());
+            column.rows = reader.varint();
+            column.offset = reader.varint();
+            column.size = reader.varint();
+        }
+        _data_start = sizeof(header_size) + header_size;
+    }
+
+    const ColumnInfo &column(const std::string &name) const
+    {
+        for (const auto &column : columns)
+        {
+            if (column.name == name)
+                return column;
+        }
+        throw std::runtime_error("no column " + name);
+    }
+
+    // only this column's bytes are read from disk
+    std::string load(const ColumnInfo &column)
+    {
+        std::string blob(static_cast<std::size_t>(column.size), '\0');
+        _in.seekg(static_cast<std::streamoff>(_data_start + column.offset));
+        if (!_in.read(&blob[0], static_cast<std::streamsize>(blob.size())))
+            throw std::runtime_error("truncated column " + column.name);
+        return blob;
+    }
+
+    // integer values of a VARINT, DELTA_VARINT or RLE_U8 column
+    std::vector<std::int64_t> integers(const std::string &name)
+    {
+        const ColumnInfo &info = column(name);
+        const std::string blob = load(info);
+        Reader reader(blob.data(), blob.size());
+        std::vector<std::int64_t> values;
+        values.reserve(static_cast<std::size_t>(info.rows));
+        std::int64_t previous = 0;
+        while (values.size() < info.rows)
+        {
+            switch (info.encoding)
+            {
+            case Encoding::DELTA_VARINT:
+                previous += unzigzag(reader.varint());
+                values.push_back(previous);
+                break;
+            case Encoding::VARINT:
+                values.push_back(static_cast<std::int64_t>(reader.varint()));
+                break;
+            case Encoding::RLE_U8: {
+                const std::uint8_t value = reader.byte();
+                values.insert(values.end(), static_cast<std::size_t>(reader.varint()), value);
+                break;
+            }
+            default:
+                throw std::runtime_error(name + " is not an integer column");
+            }
+        }
+        return values;
+    }
+
+    std::vector<double> numbers(const std::string &name)
+    {
+        const ColumnInfo &info = column(name);
+        if (info.encoding != Encoding::FLOAT64)
+        {
+            const auto ints = integers(name);
+            return {ints.begin(), ints.end()};
+        }
+        const std::string blob = load(info);
+        Reader reader(blob.data(), blob.size());
+        std::vector<double> values(static_cast<std::size_t>(info.rows));
+        for (auto &value : values)
+            value = reader.float64();
+        return values;
+    }
+
+    std::uint64_t rows{};
+    std::vector<std::string> callsites;
+    std::vector<std::string> templates;
+    std::vector<ColumnInfo> columns;
+
+  private:
+    std::ifstream _in;
+    std::uint64_t _data_start{};
+};
+
+std::string levelName(const std::int64_t level)
+{
+    return level >= 0 && level < 5 ? LEVELS[level] : "-";
+}
+
+void printCounts(const std::map<std::string, std::uint64_t> &counts)
+{
+    std::vector<std::pair<std::string, std::uint64_t>> sorted(counts.begin(), counts.end());
+    std::sort(sorted.begin(), sorted.end(),
+              [](const auto &a, const auto &b) { return a.second > b.second; });
+    for (const auto &[key, count] : sorted)
+        std::printf("%12llu  %s\n", static_cast<unsigned long long>(count), key.c_str());
+}
+
+int count(const std::string &path, const std::string &by)
+{
+    ColumnFile file(path);
+    std::map<std::string, std::uint64_t> counts;
+    if (by == "level")
+    {
+        for (const auto level : file.integers("level"))
+            ++counts[levelName(level)];
+    }
+    else if (by == "callsite" || by == "template")
+    {
+        const auto &names = by == "callsite" ? file.callsites : file.templates;
+        std::vector<std::uint64_t> per_id(names.size());
+        for (const auto id : file.integers(by))
+            ++per_id[static_cast<std::size_t>(id)];
+        for (std::size_t id = 0; id < names.size(); ++id)
+            counts[by == "template" ? std::to_string(id) + "  " + names[id] : names[id]] =
+                per_id[id];
+    }
+    else
+    {
+        std::fprintf(stderr, "zerg-columnar: --by level|callsite|template\n");
+        return 2;
+    }
+    printCounts(counts);
+    return 0;
+}
+
+int countText(const std::string &path, const std::string &by)
+{
+    std::ifstream in(path);
+    std::map<std::string, std::uint64_t> counts;
+    Record record;
+    std::vector<Slot> slots;
+    for (std::string line; std::getline(in, line);)
+    {
+        if (!parseRecord(line, record))
+        {
+            record.level = NO_LEVEL;
+            record.callsite.clear();
+            record.message = line;
+        }
+        if (by == "level")
+            ++counts[levelName(record.level)];
+        else if (by == "callsite")
+            ++counts[record.callsite];
+        else
+            ++counts[extractTemplate(record.message, slots)];
+    }
+    printCounts(counts);
+    return 0;
+}
+
+int stats(const std::string &path, const std::string &template_id, const std::string &arg)
+{
+    ColumnFile file(path);
+    auto values = file.numbers("t" + template_id + "." + arg);
+    if (values.empty())
+        return 1;
+    std::sort(values.begin(), values.end());
+    double sum = 0;
+    for (const double value : values)
+        sum += value;
+    auto at = [&](const double p) {
+        return values[static_cast<std::size_t>(p * static_cast<double>(values.size() - 1))];
+    };
+    std::printf("template %s: %s\nslot %s: count %zu min %g p50 %g p99 %g max %g mean %g\n",
+                template_id.c_str(), file.templates.at(std::stoul(template_id)).c_str(),
+                arg.c_str(), values.size(), values.front(), at(0.5), at(0.99), values.back(),
+                sum / static_cast<double>(values.size()));
+    return 0;
+}
+
+int schema(const std::string &path)
+{
+    ColumnFile file(path);
+    std::printf("%llu rows, %zu callsites\n\ntemplates:\n",
+                static_cast<unsigned long long>(file.rows), file.callsites.size());
+    for (std::size_t id = 0; id < file.templates.size(); ++id)
+        std::printf("  %4zu  %s\n", id, file.templates[id].c_str());
+    std::printf("\ncolumns:\n");
+    for (const auto &column : file.columns)
+    {
+        std::printf("  %-20s %-12s rows %-10llu bytes %llu\n", column.name.c_str(),
+                    column.encoding == Encoding::DELTA_VARINT ? "delta"
+                    : column.encoding == Encoding::RLE_U8     ? "rle"
+                    : column.encoding == Encoding::VARINT     ? "varint"
+                    : column.encoding == Encoding::FLOAT64    ? "float64"
+                                                              : "dictionary",
+                    static_cast<unsigned long long>(column.rows),
+                    static_cast<unsigned long long>(column.size));
+    }
+    return 0;
+}
+
+int usage()
+{
+    std::fprintf(stderr,
+                 "usage: zerg-columnar convert LOG [OUT]\n"
+                 "       zerg-columnar schema FILE.zcol\n"
+                 "       zerg-columnar count FILE.zcol --by level|callsite|template\n"
+                 "       zerg-columnar stats FILE.zcol --template N --arg K\n"
+                 "       zerg-columnar count-text LOG --by level|callsite|template\n"
+                 "  -v prints timings\n");
+    return 2;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::vector<std::string> positional;
+    std::map<std::string, std::string> options;
+    bool verbose = false;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "-v")
+            verbose = true;
+        else if (arg.rfind("--", 0) == 0 && i + 1 < argc)
+            options[arg.substr(2)] = argv[++i];
+        else
+            positional.push_back(arg);
+    }
+    if (positional.size() < 2)
+        return usage();
+
+    const std::string &command = positional[0];
+    const std::string &path = positional[1];
+    const auto start = std::chrono::steady_clock::now();
+    int status = 0;
+    try
+    {
+        if (command == "convert")
+            status = convert(path, positional.size() > 2 ? positional[2] : path + ".zcol", verbose);
+        else if (command == "schema")
+            status = schema(path);
+        else if (command == "count")
+            status = count(path, options["by"]);
+        else if (command == "count-text")
+            status = countText(path, options["by"]);
+        else if (command == "stats" && options.count("template") && options.count("arg"))
+            status = stats(path, options["template"], options["arg"]);
+        else
+            return usage();
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "zerg-columnar: %s\n", e.what());
+        return 2;
+    }
+    if (verbose && command != "convert")
+    {
+        std::fprintf(stderr, "%.3f ms\n",
+                     std::chrono::duration<double, std::milli>(std::chrono::steady_clock::now() -
+                                                               start)
+                         .count());
+    }
+    return status;
+}
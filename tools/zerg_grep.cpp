@@ -0,0 +1,153 @@
+// zerg-grep: extract a time range (and optionally a substring) from a large zerg log
+//
+//   zerg-grep --from "2025-01-31 12:00:00" --to "2025-01-31 12:05:00" app.log
+//   zerg-grep --from "2025-01-31 12:00:00.250000" -e "ERROR" app.log
+//
+// With the FileLogBackend sidecar index ("app.log.idx", FileLogOptions::index) the start and
+// end of the range are found by binary search and only the index stretches that can hold it
+// are scanned, through mmap. Without an index the whole file is scanned. Times are local
+// time, as written by the logger; a --to without a fraction includes the whole second. -v
+// prints what was scanned to stderr.
+
+#include "../include/zerg/backend/file_index.hpp"
+#include "../include/zerg/backend/log_timestamp.hpp"
+
+#include <algorithm>
+#include <cstdint>
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+namespace
+{
+constexpr std::int64_t NS_PER_SECOND = zerg::LogTimestampParser::NS_PER_SECOND;
+
+int usage()
+{
+    std::fprintf(stderr, "usage: zerg-grep [--from TIME] [--to TIME] [-e TEXT] [-v] file\n"
+                         "  TIME is \"YYYY-MM-DD HH:MM:SS[.ffffff]\" (local time)\n");
+    return 2;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::int64_t from = INT64_MIN;
+    std::int64_t to = INT64_MAX;
+    std::string pattern;
+    std::string path;
+    bool verbose = false;
+    zerg::LogTimestampParser parser;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if ((arg == "--from" || arg == "--to" || arg == "-e") && i + 1 < argc)
+        {
+            const char *value = argv[++i];
+            if (arg == "-e")
+            {
+                pattern = value;
+                continue;
+            }
+            const std::size_t length = std::strlen(value);
+            std::int64_t ns = parser.parse(value, length);
+            if (ns < 0)
+                return usage();
+            // index timestamps carry nanoseconds: a whole second --to covers all of it
+            if (arg == "--to" && (length < 21 || value[19] != '.'))
+                ns += NS_PER_SECOND - 1;
+            (arg == "--from" ? from : to) = ns;
+        }
+        else if (arg == "-v")
+            verbose = true;
+        else if (path.empty() && arg[0] != '-')
+            path = arg;
+        else
+            return usage();
+    }
+    if (path.empty())
+        return usage();
+
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st{};
+    if (fd < 0 || ::fstat(fd, &st) != 0)
+    {
+        std::perror(path.c_str());
+        return 2;
+    }
+    const auto size = static_cast<std::uint64_t>(st.st_size);
+    if (size == 0)
+        return 0;
+
+    std::uint64_t begin = 0;
+    std::uint64_t end = size;
+    try
+    {
+        const auto index = zerg::readFileIndex(zerg::fileIndexPath(path));
+        if (!index.empty())
+        {
+            begin = std::min(size, from == INT64_MIN ? 0 : zerg::indexStartOffset(index, from));
+            end = std::min(size, zerg::indexEndOffset(index, to));
+        }
+        if (verbose)
+            std::fprintf(stderr, "index entries: %zu\n", index.size());
+    }
+    catch (const std::exception &e)
+    {
+        std::fprintf(stderr, "zerg-grep: %s, scanning the whole file\n", e.what());
+    }
+
+    auto *data = static_cast<const char *>(
+        ::mmap(nullptr, static_cast<std::size_t>(size), PROT_READ, MAP_PRIVATE, fd, 0));
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        std::perror("mmap");
+        return 2;
+    }
+    // madvise wants a page aligned start, index offsets are record boundaries
+    const auto page = static_cast<std::uint64_t>(::sysconf(_SC_PAGESIZE));
+    const std::uint64_t advised = begin / page * page;
+    ::madvise(const_cast<char *>(data) + advised, static_cast<std::size_t>(end - advised),
+              MADV_SEQUENTIAL);
+
+    std::uint64_t matched = 0;
+    std::int64_t last_time = -1;
+    const char *cursor = data + begin;
+    const char *const stop = data + end;
+    while (cursor < stop)
+    {
+        const auto remaining = static_cast<std::size_t>(stop - cursor);
+        const char *newline = static_cast<const char *>(std::memchr(cursor, '\n', remaining));
+        const char *line_end = newline != nullptr ? newline : stop;
+        const auto length = static_cast<std::size_t>(line_end - cursor);
+
+        // lines without a timestamp belong to the record before them
+        const std::int64_t stamp = parser.parse(cursor, length);
+        if (stamp >= 0)
+            last_time = stamp;
+        if (last_time >= from && last_time <= to &&
+            (pattern.empty() ||
+             std::search(cursor, line_end, pattern.begin(), pattern.end()) != line_end))
+        {
+            std::fwrite(cursor, 1, length, stdout);
+            std::fputc('\n', stdout);
+            ++matched;
+        }
+        cursor = line_end + 1;
+    }
+
+    if (verbose)
+    {
+        std::fprintf(stderr, "scanned %llu of %llu bytes, %llu lines matched\n",
+                     static_cast<unsigned long long>(end - begin),
+                     static_cast<unsigned long long>(size),
+                     static_cast<unsigned long long>(matched));
+    }
+    ::munmap(const_cast<char *>(data), static_cast<std::size_t>(size));
+    return 0;
+}
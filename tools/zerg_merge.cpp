@@ -0,0 +1,135 @@
+// zerg-merge: k-way merge of per-thread / per-node zerg log files by timestamp
+//
+//   zerg-merge [-o merged.log] app.log.t0 app.log.t1 ...
+//   zerg-merge app.log.t* | grep ERROR
+//
+// Every input is already in timestamp order (one producer per file, see PerThreadLogger),
+// so a heap over the current head line of each file yields one ordered stream while
+// holding a single line per input in memory. Records are keyed by their
+// "YYYY-MM-DD HH:MM:SS[.ffffff]" prefix, read by the same parser as zerg-grep.
+// Lines without a timestamp (continuations) stay with the record before them. Ties go to
+// the file listed first.
+
+#include "../include/zerg/backend/log_timestamp.hpp"
+
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <iostream>
+#include <memory>
+#include <queue>
+#include <string>
+#include <vector>
+
+namespace
+{
+constexpr std::size_t INPUT_BUFFER = 1 << 20;
+
+struct Source
+{
+    std::ifstream in;
+    std::vector<char> buffer;
+    std::string line;
+    zerg::LogTimestampParser parser;
+    std::int64_t key{};
+    std::size_t index{};
+};
+
+// read the next record head, passing leading continuation lines straight to out
+bool advance(Source &source, std::ostream &out)
+{
+    while (std::getline(source.in, source.line))
+    {
+        if ((source.key = source.parser.parse(source.line.data(), source.line.size())) >= 0)
+            return true;
+        out << source.line << '\n';
+    }
+    return false;
+}
+
+struct Later
+{
+    bool operator()(const Source *a, const Source *b) const
+    {
+        return a->key != b->key ? a->key > b->key : a->index > b->index;
+    }
+};
+
+int usage()
+{
+    std::cerr << "usage: zerg-merge [-o output] file...\n";
+    return 2;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::ios::sync_with_stdio(false);
+    std::string output;
+    std::vector<std::string> inputs;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-o") == 0)
+        {
+            if (++i == argc)
+                return usage();
+            output = argv[i];
+        }
+        else if (std::strcmp(argv[i], "-h") == 0 || std::strcmp(argv[i], "--help") == 0)
+        {
+            return usage();
+        }
+        else
+        {
+            inputs.emplace_back(argv[i]);
+        }
+    }
+    if (inputs.empty())
+        return usage();
+
+    std::ofstream file;
+    std::vector<char> out_buffer(INPUT_BUFFER);
+    if (!output.empty())
+    {
+        file.rdbuf()->pubsetbuf(out_buffer.data(), static_cast<std::streamsize>(out_buffer.size()));
+        file.open(output, std::ios::out | std::ios::trunc);
+        if (!file)
+        {
+            std::cerr << "zerg-merge: cannot open " << output << "\n";
+            return 2;
+        }
+    }
+    std::ostream &out = output.empty() ? std::cout : file;
+
+    std::vector<std::unique_ptr<Source>> sources;
+    std::priority_queue<Source *, std::vector<Source *>, Later> heads;
+    for (std::size_t i = 0; i < inputs.size(); ++i)
+    {
+        auto source = std::make_unique<Source>();
+        source->index = i;
+        source->buffer.resize(INPUT_BUFFER);
+        source->in.rdbuf()->pubsetbuf(source->buffer.data(),
+                                      static_cast<std::streamsize>(source->buffer.size()));
+        source->in.open(inputs[i]);
+        if (!source->in)
+        {
+            std::cerr << "zerg-merge: cannot open " << inputs[i] << "\n";
+            return 2;
+        }
+        if (advance(*source, out))
+            heads.push(source.get());
+        sources.push_back(std::move(source));
+    }
+
+    while (!heads.empty())
+    {
+        Source *source = heads.top();
+        heads.pop();
+        out << source->line << '\n';
+        // continuation lines follow their record before any other input gets a turn
+        if (advance(*source, out))
+            heads.push(source);
+    }
+    out.flush();
+    return out ? 0 : 1;
+}
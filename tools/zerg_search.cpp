@@ -0,0 +1,178 @@
+// zerg-search: find records containing all tokens of a query across many log segments
+//
+//   zerg-search req-8f14e45f app.log*
+//   zerg-search -l "user:42 ERROR" /var/log/app/*.log
+//
+// Segments with a FileLogBackend token filter ("app.log.bloom", FileLogOptions::bloom) that
+// rules the query out are skipped without reading them. A filter is only trusted when it
+// covers the whole file as it is now, otherwise (and for segments without one) the file is
+// scanned. Matching is by whole token, the way the filter was built (see forEachToken). -v
+// prints skip statistics.
+
+#include "../include/zerg/backend/token_bloom.hpp"
+
+#include <cstdio>
+#include <cstring>
+#include <fcntl.h>
+#include <string>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+#include <vector>
+
+namespace
+{
+struct Query
+{
+    std::vector<std::string> tokens;
+
+    bool matches(const char *line, const std::size_t size) const
+    {
+        std::vector<bool> found(tokens.size(), false);
+        std::size_t remaining = tokens.size();
+        zerg::forEachToken(line, size, [&](const char *t, const std::size_t n) {
+            for (std::size_t i = 0; i < tokens.size(); ++i)
+            {
+                if (!found[i] && tokens[i].size() == n && tokens[i].compare(0, n, t, n) == 0)
+                {
+                    found[i] = true;
+                    --remaining;
+                }
+            }
+        });
+        return remaining == 0;
+    }
+};
+
+// -1 = unreadable, otherwise matching lines
+long scanSegment(const std::string &path, const Query &query, const bool prefix,
+                 const bool list_only)
+{
+    const int fd = ::open(path.c_str(), O_RDONLY);
+    struct stat st{};
+    if (fd < 0 || ::fstat(fd, &st) != 0)
+    {
+        std::perror(path.c_str());
+        if (fd >= 0)
+            ::close(fd);
+        return -1;
+    }
+    const auto size = static_cast<std::size_t>(st.st_size);
+    if (size == 0)
+    {
+        ::close(fd);
+        return 0;
+    }
+    auto *data = static_cast<const char *>(::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0));
+    ::close(fd);
+    if (data == MAP_FAILED)
+    {
+        std::perror(path.c_str());
+        return -1;
+    }
+    ::madvise(const_cast<char *>(data), size, MADV_SEQUENTIAL);
+
+    long matched = 0;
+    const char *cursor = data;
+    const char *const end = data + size;
+    while (cursor < end)
+    {
+        const auto remaining = static_cast<std::size_t>(end - cursor);
+        const char *newline = static_cast<const char *>(std::memchr(cursor, '\n', remaining));
+        const char *line_end = newline != nullptr ? newline : end;
+        const auto length = static_cast<std::size_t>(line_end - cursor);
+        if (query.matches(cursor, length))
+        {
+            ++matched;
+            if (list_only)
+            {
+                std::printf("%s\n", path.c_str());
+                break;
+            }
+            if (prefix)
+                std::printf("%s:", path.c_str());
+            std::fwrite(cursor, 1, length, stdout);
+            std::fputc('\n', stdout);
+        }
+        cursor = line_end + 1;
+    }
+    ::munmap(const_cast<char *>(data), size);
+    return matched;
+}
+
+// false = the filter proves the segment cannot match
+bool mayMatch(const std::string &path, const std::string &query_text)
+{
+    struct stat st{};
+    if (::stat(path.c_str(), &st) != 0)
+        return true;
+    try
+    {
+        const auto filter = zerg::TokenBloomFilter::load(zerg::tokenBloomPath(path));
+        if (filter.coveredBytes() != static_cast<std::uint64_t>(st.st_size))
+            return true; // stale, the log grew after the filter was saved
+        return filter.mayContainAll(query_text);
+    }
+    catch (const std::runtime_error &)
+    {
+        return true;
+    }
+}
+
+int usage()
+{
+    std::fprintf(stderr, "usage: zerg-search [-l] [-v] QUERY file...\n");
+    return 2;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    bool list_only = false;
+    bool verbose = false;
+    std::string query_text;
+    std::vector<std::string> files;
+    for (int i = 1; i < argc; ++i)
+    {
+        const std::string arg = argv[i];
+        if (arg == "-l")
+            list_only = true;
+        else if (arg == "-v")
+            verbose = true;
+        else if (arg == "-h" || arg == "--help")
+            return usage();
+        else if (query_text.empty())
+            query_text = arg;
+        else
+            files.push_back(arg);
+    }
+
+    Query query;
+    zerg::forEachToken(query_text.data(), query_text.size(), [&](const char *t, std::size_t n) {
+        query.tokens.emplace_back(t, n);
+    });
+    if (query.tokens.empty() || files.empty())
+        return usage();
+
+    std::size_t skipped = 0;
+    long matched = 0;
+    bool failed = false;
+    for (const auto &file : files)
+    {
+        if (!mayMatch(file, query_text))
+        {
+            ++skipped;
+            continue;
+        }
+        const long found = scanSegment(file, query, files.size() > 1, list_only);
+        failed |= found < 0;
+        matched += found < 0 ? 0 : found;
+    }
+    if (verbose)
+    {
+        std::fprintf(stderr, "%zu of %zu segments skipped by their filter, %ld lines matched\n",
+                     skipped, files.size(), matched);
+    }
+    // grep convention: 0 = found, 1 = nothing found, 2 = error
+    return failed ? 2 : (matched > 0 ? 0 : 1);
+}
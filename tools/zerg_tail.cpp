@@ -0,0 +1,292 @@
+// zerg-tail: follow a zerg log across rotation without losing or splitting records
+//
+//   zerg-tail app.log              last 10 records, then follow
+//   zerg-tail -n 100 app.log       last 100 records, then follow
+//   zerg-tail -n 0 -q app.log      follow only new records, exit once the file is deleted
+//
+// The file and its directory are watched through inotify, so an idle log costs no CPU.
+// Reads are large preads from the last offset and only complete, newline terminated records
+// are printed; a record still being written stays buffered until its newline arrives.
+// Rotation is detected when the path names a different inode: the old file (renamed,
+// or unlinked after compression) keeps being drained through the descriptor still held on
+// it until the new file appears, then its unterminated tail is dropped (and reported on
+// stderr) and the new file is followed from offset 0. A file that shrinks in place
+// (copytruncate) is followed from the start again.
+
+#include <algorithm>
+#include <cerrno>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <fcntl.h>
+#include <limits.h>
+#include <poll.h>
+#include <string>
+#include <sys/inotify.h>
+#include <sys/stat.h>
+#include <sys/types.h>
+#include <unistd.h>
+#include <utility>
+#include <vector>
+
+namespace
+{
+constexpr std::size_t READ_SIZE = 1 << 20;
+// inotify covers the common cases; the periodic check catches filesystems without it (NFS)
+constexpr int POLL_TIMEOUT_MS = 1000;
+
+class Follower
+{
+  public:
+    explicit Follower(std::string path) : _path(std::move(path)), _buffer(READ_SIZE) {}
+
+    ~Follower() { closeFile(); }
+
+    // open the current file, returns false while it does not exist
+    bool open()
+    {
+        closeFile();
+        _fd = ::open(_path.c_str(), O_RDONLY | O_CLOEXEC);
+        if (_fd < 0)
+            return false;
+        struct stat st;
+        fstat(_fd, &st);
+        _dev = st.st_dev;
+        _ino = st.st_ino;
+        _offset = 0;
+        _pending.clear();
+        return true;
+    }
+
+    bool isOpen() const { return _fd >= 0; }
+
+    // start printing at the last `records` complete records instead of the beginning
+    void seekToLast(const std::size_t records)
+    {
+        struct stat st;
+        if (fstat(_fd, &st) != 0)
+            return;
+        off_t end = st.st_size;
+        std::size_t newlines = 0;
+        // an unterminated tail is not a record yet, it is picked up by the first drain
+        while (end > 0)
+        {
+            const auto size = static_cast<std::size_t>(std::min<off_t>(end, READ_SIZE));
+            const ssize_t got = pread(_fd, _buffer.data(), size, end - static_cast<off_t>(size));
+            if (got <= 0)
+                break;
+            end -= static_cast<off_t>(size);
+            for (ssize_t i = got - 1; i >= 0; --i)
+            {
+                if (_buffer[static_cast<std::size_t>(i)] != '\n')
+                    continue;
+                // the newline ending the (records + 1)th last record starts the output
+                if (++newlines > records)
+                {
+                    _offset = end + i + 1;
+                    return;
+                }
+            }
+        }
+        _offset = 0;
+    }
+
+    void skipToEnd()
+    {
+        struct stat st;
+        if (fstat(_fd, &st) == 0)
+            _offset = st.st_size;
+    }
+
+    // print every complete record past the offset
+    void drain()
+    {
+        struct stat st;
+        if (fstat(_fd, &st) == 0 && st.st_size < _offset)
+        {
+            // truncated in place
+            _offset = 0;
+            _pending.clear();
+        }
+        for (;;)
+        {
+            const ssize_t got = pread(_fd, _buffer.data(), _buffer.size(), _offset);
+            if (got < 0 && errno == EINTR)
+                continue;
+            if (got <= 0)
+                break;
+            _offset += got;
+            emit(_buffer.data(), static_cast<std::size_t>(got));
+        }
+        std::fflush(stdout);
+    }
+
+    // true once the path no longer names the file being followed
+    bool rotated() const
+    {
+        struct stat st;
+        if (stat(_path.c_str(), &st) != 0)
+            return true;
+        return st.st_dev != _dev || st.st_ino != _ino;
+    }
+
+    // the writer has moved on: drain the old file. An unterminated tail left in it is a
+    // record that was never finished, it is reported instead of printed
+    void finish()
+    {
+        drain();
+        if (!_pending.empty())
+        {
+            std::fprintf(stderr, "zerg-tail: %s: dropped %zu bytes of an unterminated record\n",
+                         _path.c_str(), _pending.size());
+            _pending.clear();
+        }
+        closeFile();
+    }
+
+  private:
+    void emit(const char *data, const std::size_t size)
+    {
+        const char *last = static_cast<const char *>(memrchr(data, '\n', size));
+        if (last == nullptr)
+        {
+            _pending.append(data, size);
+            return;
+        }
+        const auto complete = static_cast<std::size_t>(last - data) + 1;
+        if (!_pending.empty())
+        {
+            std::fwrite(_pending.data(), 1, _pending.size(), stdout);
+            _pending.clear();
+        }
+        std::fwrite(data, 1, complete, stdout);
+        _pending.append(data + complete, size - complete);
+    }
+
+    void closeFile()
+    {
+        if (_fd >= 0)
+            ::close(_fd);
+        _fd = -1;
+    }
+
+    std::string _path;
+    std::vector<char> _buffer;
+    std::string _pending; // start of a record whose newline has not been written yet
+    int _fd{-1};
+    dev_t _dev{};
+    ino_t _ino{};
+    off_t _offset{};
+};
+
+bool exists(const char *path)
+{
+    struct stat st;
+    return stat(path, &st) == 0;
+}
+
+std::string directoryOf(const std::string &path)
+{
+    const auto slash = path.rfind('/');
+    if (slash == std::string::npos)
+        return ".";
+    return slash == 0 ? "/" : path.substr(0, slash);
+}
+
+int usage()
+{
+    std::fprintf(stderr, "usage: zerg-tail [-n RECORDS] [-q] FILE\n"
+                         "  -q  exit once the file is deleted or renamed and not recreated\n");
+    return 2;
+}
+} // namespace
+
+int main(int argc, char **argv)
+{
+    std::size_t records = 10;
+    bool quit_on_delete = false;
+    const char *path = nullptr;
+    for (int i = 1; i < argc; ++i)
+    {
+        if (std::strcmp(argv[i], "-n") == 0 && i + 1 < argc)
+            records = std::strtoull(argv[++i], nullptr, 10);
+        else if (std::strcmp(argv[i], "-q") == 0)
+            quit_on_delete = true;
+        else if (argv[i][0] == '-' || path != nullptr)
+            return usage();
+        else
+            path = argv[i];
+    }
+    if (path == nullptr)
+        return usage();
+
+    const int notify = inotify_init1(IN_NONBLOCK | IN_CLOEXEC);
+    if (notify < 0)
+    {
+        std::perror("zerg-tail: inotify_init1");
+        return 2;
+    }
+    // the directory reports the new file of a rotation, the file reports writes to it
+    if (inotify_add_watch(notify, directoryOf(path).c_str(),
+                          IN_CREATE | IN_MOVED_TO | IN_MOVED_FROM | IN_DELETE) < 0)
+    {
+        std::perror("zerg-tail: inotify_add_watch");
+        return 2;
+    }
+
+    Follower follower(path);
+    int file_watch = -1;
+    auto watchFile = [&] {
+        if (file_watch >= 0)
+            inotify_rm_watch(notify, file_watch);
+        file_watch = inotify_add_watch(notify, path, IN_MODIFY | IN_CLOSE_WRITE);
+    };
+
+    if (follower.open())
+    {
+        watchFile();
+        if (records == 0)
+            follower.skipToEnd();
+        else
+            follower.seekToLast(records);
+        follower.drain();
+    }
+    else if (quit_on_delete)
+    {
+        std::fprintf(stderr, "zerg-tail: cannot open %s\n", path);
+        return 2;
+    }
+
+    alignas(struct inotify_event) char events[4096];
+    for (;;)
+    {
+        struct pollfd pfd = {notify, POLLIN, 0};
+        const int ready = poll(&pfd, 1, POLL_TIMEOUT_MS);
+        if (ready < 0 && errno != EINTR)
+            break;
+        // contents do not matter, every event leads to the same checks
+        while (read(notify, events, sizeof(events)) > 0)
+        {
+        }
+
+        if (follower.isOpen())
+        {
+            follower.drain();
+            if (!follower.rotated())
+                continue;
+            // until the replacement shows up the writer may still append to the old file
+            if (!exists(path) && !quit_on_delete)
+                continue;
+            follower.finish();
+        }
+        if (follower.open())
+        {
+            watchFile();
+            follower.drain();
+        }
+        else if (quit_on_delete)
+            break;
+    }
+    close(notify);
+    return 0;
+}